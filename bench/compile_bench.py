@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+Compile-time cost benchmarks for hybstr.hpp.
+
+Generates translation units that stress the constexpr side of the library
+(deep operator+ chains, many fit_string calls, large buffers, NTTP literals),
+compiles each one with every compiler found, in C++17 and C++20, and reports:
+
+  - wall time (best of --repeat runs)
+  - peak compiler memory (POSIX: wait4 rusage; Windows: psutil if installed)
+  - template instantiation / constant evaluation time (GCC -ftime-report, Clang -ftime-trace)
+  - instantiation counts (Clang -ftime-trace events only; the JSON output also has the
+    hybstr symbols nm finds in the object for GCC/MSVC, which constexpr-only code never emits)
+  - with --steps, the largest single constant evaluation, found by bisecting
+    -fconstexpr-ops-limit (GCC) / -fconstexpr-steps (Clang)
+
+Usage:
+  python3 bench/compile_bench.py [--compilers g++ clang++ cl] [--std 17 20]
+                                 [--scale 1] [--repeat 3] [--steps] [--json out.json]
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+# ======================================================================
+#                           Generated cases
+# ======================================================================
+
+def case_include_only(scale, std):
+    return "int main() {}\n"
+
+
+def case_concat_chain(scale, std):
+    depth = 32 * scale
+    pieces = " + ".join('s{} + "-"'.format(i % 8) for i in range(depth))
+    decls = "".join('constexpr auto s{0} = hybstr::string("part{0}");\n'.format(i) for i in range(8))
+    return (decls
+            + "constexpr hybstr::string_impl chain = {};\n".format(pieces)
+            + "static_assert(chain.size() == {});\n".format(depth * 6)
+            + "int main() { return static_cast<int>(chain.size() & 1); }\n")
+
+
+def block_scope(lines, std):
+    """The C++17 HYBSTR_FIT_STRING lambda captures, so it is only usable at block scope."""
+    if std >= 20:
+        return "".join(lines)
+    return "void cases()\n{\n" + "".join("\t" + line for line in lines) + "}\n"
+
+
+def case_fit_string(scale, std):
+    count = 64 * scale
+    lines = []
+    for i in range(count):
+        if std >= 20:
+            lines.append('constexpr auto f{0} = hybstr::fit_string<hybstr::string<256>("fitted literal {0}")>();\n'.format(i))
+        else:
+            lines.append('constexpr auto f{0} = HYBSTR_FIT_STRING(hybstr::string<256>("fitted literal {0}"));\n'.format(i))
+    return block_scope(lines, std) + "int main() {}\n"
+
+
+def case_big_buffer(scale, std):
+    ops = 4 * scale
+    lines = ['constexpr auto b0 = hybstr::string<100000>("seed");\n']
+    for i in range(1, ops + 1):
+        lines.append('constexpr auto b{0} = HYBSTR_FIT_STRING(b{1}.append<100000>(hybstr::string("x{0}")));\n'.format(i, i - 1))
+    lines.append("static_assert(b{}.size() == {});\n".format(ops, 4 + sum(len("x{}".format(i)) for i in range(1, ops + 1))))
+    return block_scope(lines, std) + "int main() {}\n"
+
+
+def case_nttp_literals(scale, std):
+    count = 64 * scale
+    lines = ["using namespace hybstr::literals;\n"]
+    for i in range(count):
+        lines.append('constexpr auto l{0} = "metric.name.{0}"_hyb;\n'.format(i))
+    if std >= 20:
+        keys = ", ".join('"key{}"_hyb'.format(i) for i in range(min(count, 128)))
+        lines.append("constexpr hybstr::static_map<int, {}> table{{}};\n".format(keys))
+        for i in range(count):
+            lines.append('constexpr auto& i{0} = hybstr::intern<"metric.name.{0}"_hyb>();\n'.format(i))
+    return "".join(lines) + "int main() {}\n"
+
+
+CASES = {
+    "include_only": case_include_only,
+    "concat_chain": case_concat_chain,
+    "fit_string": case_fit_string,
+    "big_buffer": case_big_buffer,
+    "nttp_literals": case_nttp_literals,
+}
+
+
+# ======================================================================
+#                           Compilers
+# ======================================================================
+
+class Compiler:
+    def __init__(self, name, path):
+        self.name = name
+        self.path = path
+        self.kind = "msvc" if name == "cl" else ("clang" if "clang" in name else "gcc")
+
+    def command(self, src, obj, std, extra=()):
+        if self.kind == "msvc":
+            return [self.path, "/nologo", "/c", "/std:c++{}".format("latest" if std >= 20 else std),
+                    "/EHsc", "/I" + ROOT, src, "/Fo" + obj] + list(extra)
+        return [self.path, "-std=c++{}".format(std), "-c", "-I" + ROOT, src, "-o", obj] + list(extra)
+
+    def trace_flags(self):
+        if self.kind == "gcc":
+            return ["-ftime-report"]
+        if self.kind == "clang":
+            return ["-ftime-trace", "-ftime-trace-granularity=0"]
+        return []
+
+    def steps_flag(self, limit):
+        if self.kind == "gcc":
+            return ["-fconstexpr-ops-limit={}".format(limit)]
+        if self.kind == "clang":
+            return ["-fconstexpr-steps={}".format(limit)]
+        return None
+
+
+def find_compilers(names):
+    found = []
+    for name in names:
+        path = shutil.which(name)
+        if path:
+            found.append(Compiler(name, path))
+    return found
+
+
+# ======================================================================
+#                           Measurement
+# ======================================================================
+
+def run(cmd):
+    """Runs @p cmd and returns (returncode, output, wall seconds, peak memory in MiB or None)."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    peak = None
+    if hasattr(os, "wait4"):
+        output = proc.stdout.read()
+        _, status, usage = os.wait4(proc.pid, 0)
+        proc.returncode = os.waitstatus_to_exitcode(status) if hasattr(os, "waitstatus_to_exitcode") else status
+        # ru_maxrss is in KiB on Linux and in bytes on macOS.
+        peak = usage.ru_maxrss / (1024 * 1024 if platform.system() == "Darwin" else 1024)
+    else:
+        try:
+            import psutil
+            handle = psutil.Process(proc.pid)
+            peak_bytes = 0
+            while proc.poll() is None:
+                try:
+                    peak_bytes = max(peak_bytes, handle.memory_info().peak_wset)
+                except psutil.Error:
+                    break
+                time.sleep(0.01)
+            peak = peak_bytes / (1024 * 1024) or None
+        except ImportError:
+            pass
+        output = proc.communicate()[0]
+    wall = time.perf_counter() - start
+    return proc.returncode, output.decode(errors="replace"), wall, peak
+
+
+def parse_gcc_report(output):
+    phases = {}
+    for label, key in (("template instantiation", "instantiation_s"),
+                       ("constant expression evaluation", "constexpr_s")):
+        # Columns: usr, sys, wall, GGC; keep the wall time.
+        match = re.search(r"^\s*{}\s*:\s*[\d.]+\s*\(\s*\d+%\)\s*[\d.]+\s*\(\s*\d+%\)\s*([\d.]+)".format(re.escape(label)),
+                          output, re.M)
+        if match:
+            phases[key] = float(match.group(1))
+    return phases
+
+
+def parse_clang_trace(obj):
+    trace = os.path.splitext(obj)[0] + ".json"
+    if not os.path.exists(trace):
+        return {}
+    with open(trace) as f:
+        events = json.load(f).get("traceEvents", [])
+    result = {"instantiations": 0, "instantiation_s": 0.0, "constexpr_s": 0.0}
+    for event in events:
+        name = event.get("name", "")
+        duration = event.get("dur", 0) / 1e6
+        if name in ("InstantiateClass", "InstantiateFunction"):
+            result["instantiations"] += 1
+        if name == "Total InstantiateClass" or name == "Total InstantiateFunction":
+            result["instantiation_s"] += duration
+        if name == "Total EvaluateAsConstantExpr" or name == "Total EvaluateAsRValue":
+            result["constexpr_s"] += duration
+    return result
+
+
+def count_symbols(obj):
+    nm = shutil.which("nm")
+    if not nm or not os.path.exists(obj):
+        return None
+    proc = subprocess.run([nm, "-C", obj], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    return sum(1 for line in proc.stdout.decode(errors="replace").splitlines() if "hybstr::" in line)
+
+
+def bisect_steps(compiler, src, obj, std):
+    """Smallest limit that compiles, i.e. the cost of the largest single constant evaluation."""
+    if compiler.steps_flag(1) is None:
+        return None
+    low, high = 1, 1 << 20
+    while run(compiler.command(src, obj, std, compiler.steps_flag(high)))[0] != 0:
+        low, high = high, high << 2
+        if high > 1 << 36:
+            return None
+    while low < high:
+        mid = (low + high) // 2
+        if run(compiler.command(src, obj, std, compiler.steps_flag(mid)))[0] == 0:
+            high = mid
+        else:
+            low = mid + 1
+    return high
+
+
+def measure(compiler, case, std, args, workdir):
+    src = os.path.join(workdir, "{}_{}_{}.cpp".format(case, compiler.kind, std))
+    obj = os.path.splitext(src)[0] + (".obj" if compiler.kind == "msvc" else ".o")
+    with open(src, "w") as f:
+        f.write('#include "hybstr.hpp"\n' + CASES[case](args.scale, std))
+
+    result = {"compiler": compiler.name, "std": std, "case": case}
+    best = None
+    for _ in range(args.repeat):
+        code, output, wall, peak = run(compiler.command(src, obj, std))
+        if code != 0:
+            result["error"] = output.strip().splitlines()[-1] if output.strip() else "exit {}".format(code)
+            return result
+        if best is None or wall < best[0]:
+            best = (wall, peak)
+    result["wall_s"] = round(best[0], 4)
+    result["peak_mib"] = round(best[1], 1) if best[1] else None
+
+    flags = compiler.trace_flags()
+    if flags:
+        _, output, _, _ = run(compiler.command(src, obj, std, flags))
+        result.update(parse_gcc_report(output) if compiler.kind == "gcc" else parse_clang_trace(obj))
+    if "instantiations" not in result:
+        result["emitted_symbols"] = count_symbols(obj)
+    if args.steps:
+        result["max_constexpr_steps"] = bisect_steps(compiler, src, obj, std)
+    return result
+
+
+# ======================================================================
+#                           Driver
+# ======================================================================
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compilers", nargs="+", default=["g++", "clang++", "cl"])
+    parser.add_argument("--std", nargs="+", type=int, default=[17, 20])
+    parser.add_argument("--cases", nargs="+", default=list(CASES), choices=list(CASES))
+    parser.add_argument("--scale", type=int, default=1, help="multiplies the size of every generated case")
+    parser.add_argument("--repeat", type=int, default=3, help="compilations per measurement (best is kept)")
+    parser.add_argument("--steps", action="store_true", help="bisect the constexpr step limit (slow)")
+    parser.add_argument("--json", help="write the results to this file")
+    parser.add_argument("--keep", help="directory for the generated sources (kept after the run)")
+    args = parser.parse_args()
+
+    compilers = find_compilers(args.compilers)
+    if not compilers:
+        sys.exit("no compiler found among: " + " ".join(args.compilers))
+
+    workdir = args.keep or tempfile.mkdtemp(prefix="hybstr_bench_")
+    os.makedirs(workdir, exist_ok=True)
+
+    columns = "{:<10} {:>3} {:<14} {:>9} {:>9} {:>9} {:>9} {:>8} {:>10}"
+    header = columns.format("compiler", "std", "case", "wall s", "peak MiB", "inst s", "cexpr s", "inst", "steps")
+    print(header)
+    print("-" * len(header))
+
+    def cell(value, spec):
+        return format(value, spec) if value is not None else "-"
+
+    results = []
+    for compiler in compilers:
+        for std in args.std:
+            for case in args.cases:
+                r = measure(compiler, case, std, args, workdir)
+                results.append(r)
+                if "error" in r:
+                    print("{:<10} {:>3} {:<14} error: {}".format(compiler.name, std, case, r["error"]))
+                    continue
+                print(columns.format(
+                    compiler.name, std, case, cell(r["wall_s"], ".3f"), cell(r.get("peak_mib"), ".1f"),
+                    cell(r.get("instantiation_s"), ".3f"), cell(r.get("constexpr_s"), ".3f"),
+                    cell(r.get("instantiations"), "d"),
+                    cell(r.get("max_constexpr_steps"), "d")))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"scale": args.scale, "results": results}, f, indent=2)
+    if not args.keep:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
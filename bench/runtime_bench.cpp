@@ -0,0 +1,530 @@
+/*
+ * Runtime microbenchmarks for hybstr.hpp.
+ *
+ * Covers the constructors, every append / append_inplace overload, the operator+ variants,
+ * the comparisons, view() / str(), copy / move of large-capacity strings, sorting, string_table batch
+ * operations and decompression.
+ * Each one runs at several sizes against std::string, std::string_view and a typical fixed_string.
+ *
+ * Self-contained (no benchmark library), build with optimizations:
+ *   g++ -O2 -std=c++20 -I. bench/runtime_bench.cpp -o runtime_bench
+ *   ./runtime_bench [--filter <substring>] [--min-time <ms>] [--json <file>]
+ */
+
+#include "hybstr.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <regex>
+#include <unordered_set>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace bench
+{
+	// ======================================================================
+	//                           Harness
+	// ======================================================================
+
+	/** @brief Keeps @p value alive so the computation producing it is not optimized away. */
+	template<typename T>
+	inline void do_not_optimize(const T& value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		static volatile const void* sink;
+		sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	struct benchmark
+	{
+		std::string group;
+		std::string name;
+		std::string impl;
+		std::size_t size;
+		std::function<void(std::size_t)> run; ///< Runs the operation the given number of times.
+	};
+
+	struct result
+	{
+		const benchmark* bench;
+		double ns_per_op;
+		std::size_t iterations;
+	};
+
+	inline std::vector<benchmark>& registry()
+	{
+		static std::vector<benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	inline void add(std::string group, std::string name, std::string impl, std::size_t size, std::function<void(std::size_t)> run)
+	{
+		registry().push_back({ std::move(group), std::move(name), std::move(impl), size, std::move(run) });
+	}
+
+	/** @brief Calibrates the iteration count to @p min_time, then keeps the median of 7 samples. */
+	inline auto measure(const benchmark& b, std::chrono::nanoseconds min_time) -> result
+	{
+		using clock = std::chrono::steady_clock;
+		const auto time = [&b](std::size_t iterations)
+			{
+				const auto start = clock::now();
+				b.run(iterations);
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+			};
+
+		std::size_t iterations = 1;
+		while (time(iterations) < min_time && iterations < (std::size_t{ 1 } << 40))
+		{
+			iterations *= 2;
+		}
+
+		std::array<double, 7> samples{};
+		for (double& sample : samples)
+		{
+			sample = static_cast<double>(time(iterations).count()) / static_cast<double>(iterations);
+		}
+		std::sort(samples.begin(), samples.end());
+		return { &b, samples[samples.size() / 2], iterations };
+	}
+
+	// ======================================================================
+	//                           Baselines and inputs
+	// ======================================================================
+
+	/** @brief A typical fixed_string: inline buffer plus size, no policies and comparisons through memcmp. */
+	template<std::size_t N>
+	struct fixed_string
+	{
+		fixed_string() = default;
+		explicit fixed_string(std::string_view sv)
+			: _size(std::min(sv.size(), N))
+		{
+			std::memcpy(_data, sv.data(), _size);
+			_data[_size] = '\0';
+		}
+
+		auto append(std::string_view sv) -> fixed_string&
+		{
+			const std::size_t n = std::min(sv.size(), N - _size);
+			std::memcpy(_data + _size, sv.data(), n);
+			_size += n;
+			_data[_size] = '\0';
+			return *this;
+		}
+		auto view() const -> std::string_view
+		{
+			return { _data, _size };
+		}
+
+		friend bool operator==(const fixed_string& a, const fixed_string& b)
+		{
+			return a._size == b._size && std::memcmp(a._data, b._data, a._size) == 0;
+		}
+		friend bool operator<(const fixed_string& a, const fixed_string& b)
+		{
+			return a.view() < b.view();
+		}
+
+		char _data[N + 1]{};
+		std::size_t _size = 0;
+	};
+
+	/** @brief A string literal of @p S characters, as a 'const char(&)[S + 1]'. */
+	template<std::size_t S>
+	struct literal
+	{
+		char value[S + 1];
+
+		static constexpr auto make() -> literal
+		{
+			literal l{};
+			for (std::size_t i = 0; i < S; ++i)
+			{
+				l.value[i] = static_cast<char>('a' + i % 26);
+			}
+			l.value[S] = '\0';
+			return l;
+		}
+	};
+	template<std::size_t S>
+	inline constexpr literal<S> literal_v = literal<S>::make();
+
+	/** @brief Runtime text of @p n characters, so the inputs are not known to the optimizer. */
+	inline auto runtime_text(std::size_t n, char last = 'z') -> std::string
+	{
+		std::string text(n, ' ');
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			text[i] = static_cast<char>('a' + (i * 7 + n) % 26);
+		}
+		if (n != 0)
+		{
+			text[n - 1] = last;
+		}
+		return text;
+	}
+
+	// ======================================================================
+	//                           Benchmarks
+	// ======================================================================
+
+	template<std::size_t S, std::size_t Cap>
+	void register_size()
+	{
+		using hyb = hybstr::string_impl<Cap>;
+		using fixed = fixed_string<Cap>;
+
+		// Function-local statics: one set of inputs per size, alive for the whole run.
+		static const std::string text = runtime_text(S);
+		static const std::string other_text = runtime_text(S, 'y');
+		static const std::string_view sv = text;
+		static const hyb h(sv);
+		static const hyb h_other{ std::string_view(other_text) };
+		static const fixed f(sv);
+		static const fixed f_other{ std::string_view(other_text) };
+		static const std::string suffix = runtime_text(S / 2 + 1);
+		static const hybstr::string_impl<S / 2 + 1> h_suffix{ std::string_view(suffix) };
+		static constexpr const auto& lit = literal_v<S>.value;
+
+		// Constructors
+		add("construct", "literal", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hyb s(lit); do_not_optimize(s); } });
+		add("construct", "literal", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s(lit); do_not_optimize(s); } });
+		add("construct", "fill", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hyb s(S, 'x'); do_not_optimize(s); } });
+		add("construct", "fill", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s(S, 'x'); do_not_optimize(s); } });
+		add("construct", "string_view", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hyb s(sv); do_not_optimize(s); } });
+		add("construct", "string_view", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s(sv); do_not_optimize(s); } });
+		add("construct", "string_view", "arena_string", S, [](std::size_t n) { hybstr::arena a; for (std::size_t i = 0; i < n; ++i) { if ((i & 1023) == 0) { a.reset(); } auto s = a.make(sv); do_not_optimize(s); } });
+		add("construct", "string_view", "fixed_string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { fixed s(sv); do_not_optimize(s); } });
+		add("construct", "iterators", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hyb s(text.begin(), text.end()); do_not_optimize(s); } });
+		add("construct", "iterators", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s(text.begin(), text.end()); do_not_optimize(s); } });
+
+		// Immutable appends (new string_impl per call)
+		add("append", "literal", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = h.append(lit); do_not_optimize(s); } });
+		add("append", "string_impl", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = h.template append<S / 2 + 1>(h_suffix); do_not_optimize(s); } });
+		add("append", "string_view", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = h.template append<S / 2 + 1>(std::string_view(suffix)); do_not_optimize(s); } });
+		add("append", "char", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = h.append('!'); do_not_optimize(s); } });
+		add("append", "string_view", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s = text; s.append(suffix); do_not_optimize(s); } });
+		add("append", "string_view", "fixed_string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { fixed_string<Cap + S / 2 + 1> s(f.view()); s.append(suffix); do_not_optimize(s); } });
+
+		// In-place appends
+		add("append_inplace", "string_view", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl<2 * Cap> s; s.append_inplace(sv).append_inplace(sv); do_not_optimize(s); } });
+		add("append_inplace", "literal", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl<2 * Cap> s; s.append_inplace(lit).append_inplace(lit); do_not_optimize(s); } });
+		add("append_inplace", "char", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hyb s; for (std::size_t c = 0; c < S; ++c) { s += 'x'; } do_not_optimize(s); } });
+		add("append_inplace", "string_view", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s; s.append(sv).append(sv); do_not_optimize(s); } });
+		add("append_inplace", "char", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s; for (std::size_t c = 0; c < S; ++c) { s += 'x'; } do_not_optimize(s); } });
+		add("append_inplace", "string_view", "fixed_string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { fixed_string<2 * Cap> s; s.append(sv).append(sv); do_not_optimize(s); } });
+
+		// operator+ (materialized)
+		add("operator+", "string+literal", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl s = h + lit; do_not_optimize(s); } });
+		add("operator+", "string+string", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl s = h + h_other; do_not_optimize(s); } });
+		add("operator+", "string+string_view", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl s = h + sv; do_not_optimize(s); } });
+		add("operator+", "string+char", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl s = h + '!'; do_not_optimize(s); } });
+		add("operator+", "chain of 5", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl s = h + ", " + h_other + '-' + sv; do_not_optimize(s); } });
+		add("operator+", "lazy chain of 5", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { hybstr::string_impl s = hybstr::lazy(h) + ", " + h_other + '-' + sv; do_not_optimize(s); } });
+		add("operator+", "string+string", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s = text + other_text; do_not_optimize(s); } });
+		add("operator+", "concat of 5", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = hybstr::concat(h, ", ", h_other, '-', sv); do_not_optimize(s); } });
+		add("operator+", "chain of 5", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s = text + ", " + other_text + '-' + std::string(sv); do_not_optimize(s); } });
+
+		// Comparisons (equal length, differing in the last character)
+		add("compare", "==", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(h == h_other); } });
+		add("compare", "<", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(h < h_other); } });
+#if HYBSTR_CPP_20_OR_ABOVE
+		add("compare", "<=>", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(h <=> h_other); } });
+		add("compare", "<=>", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(text <=> other_text); } });
+#endif
+		add("compare", "==", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(text == other_text); } });
+		add("compare", "<", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(text < other_text); } });
+		add("compare", "==", "std::string_view", S, [](std::size_t n) { std::string_view o = other_text; for (std::size_t i = 0; i < n; ++i) { do_not_optimize(sv == o); } });
+		add("compare", "==", "fixed_string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(f == f_other); } });
+		add("compare", "<", "fixed_string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(f < f_other); } });
+
+		// ASCII transforms
+		add("transform", "to_upper", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = h.to_upper(); do_not_optimize(s); } });
+		add("transform", "to_upper", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s = text; std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); }); do_not_optimize(s); } });
+		add("transform", "iequals", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(hybstr::iequals(h, h_other)); } });
+		add("transform", "iequals", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(std::equal(text.begin(), text.end(), other_text.begin(), other_text.end(), [](unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); })); } });
+
+		// UTF-8 (ASCII input, the common case for protocol fields)
+		add("utf8", "is_valid_utf8", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(hybstr::is_valid_utf8(h)); } });
+		add("utf8", "is_valid_utf8", "scalar", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::size_t p = 0; while (p < text.size()) { const std::size_t len = hybstr::detail::utf8_sequence_length(text.data() + p, text.size() - p); if (len == 0) { break; } p += len; } do_not_optimize(p == text.size()); } });
+		add("utf8", "codepoint_count", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(hybstr::codepoint_count(h)); } });
+
+		// Conversions
+		add("convert", "view()", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(h.view()); } });
+		add("convert", "str()", "hybstr", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s = h.str(); do_not_optimize(s); } });
+		add("convert", "copy", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::string s = text; do_not_optimize(s); } });
+	}
+
+	/** @brief Copy and move of large-capacity strings holding @p S characters. */
+	template<std::size_t S, std::size_t Cap>
+	void register_big()
+	{
+		static const hybstr::string_impl<Cap> h{ std::string_view(runtime_text(S)) };
+		static const std::string text = runtime_text(S);
+		static const fixed_string<Cap> f{ std::string_view(text) };
+
+		add("copy_big", "copy", "hybstr<" + std::to_string(Cap) + ">", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = h; do_not_optimize(s); } });
+		add("copy_big", "move", "hybstr<" + std::to_string(Cap) + ">", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = h; auto m = std::move(s); do_not_optimize(m); } });
+		add("copy_big", "copy", "fixed_string<" + std::to_string(Cap) + ">", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = f; do_not_optimize(s); } });
+		add("copy_big", "copy", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = text; do_not_optimize(s); } });
+		add("copy_big", "move", "std::string", S, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto s = text; auto m = std::move(s); do_not_optimize(m); } });
+	}
+
+	/** @brief Sorting @p Count random keys of up to 24 characters (the copy of the unsorted batch included). */
+	template<std::size_t Count>
+	void register_sort()
+	{
+		static std::vector<std::string> strings;
+		static std::vector<hybstr::string_impl<24>> inline_keys;
+		static std::vector<hybstr::prefixed_string<24>> prefixed_keys;
+		std::uint64_t state = 42;
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			std::string key;
+			const std::size_t length = 12 + i % 13;
+			for (std::size_t j = 0; j < length; ++j)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				key += static_cast<char>('0' + (state >> 58) % 43);
+			}
+			strings.push_back(key);
+			inline_keys.emplace_back(std::string_view(key));
+			prefixed_keys.emplace_back(std::string_view(key));
+		}
+
+		add("sort", "keys", "std::sort std::string", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto v = strings; std::sort(v.begin(), v.end()); do_not_optimize(v.front()); } });
+		add("sort", "keys", "std::sort hybstr<24>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto v = inline_keys; std::sort(v.begin(), v.end()); do_not_optimize(v.front()); } });
+		add("sort", "keys", "hybstr::sort prefixed<24>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto v = prefixed_keys; hybstr::sort(v); do_not_optimize(v.front()); } });
+		add("sort", "keys", "hybstr::radix_sort prefixed<24>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto v = prefixed_keys; hybstr::radix_sort(v); do_not_optimize(v.front()); } });
+	}
+
+	/** @brief Equality filter and hashing over @p Count tags: hybstr::string_table against a vector of hybstr<64> and of std::string. */
+	template<std::size_t Count>
+	void register_table()
+	{
+		static std::vector<std::string> strings;
+		static std::vector<hybstr::string_impl<64>> rows;
+		static hybstr::string_table<64> table;
+		static hybstr::string_table<64, hybstr::table_columns::none> plain_table;
+		static const std::string_view wanted = "region=eu-west-1";
+		const std::string_view values[] = { "region=eu-west-1", "region=us-east-1", "host=db-01", "env=prod", "service=checkout-api" };
+		for (std::size_t i = 0; i < Count; ++i)
+		{
+			strings.emplace_back(values[i * 7 % 5]);
+			rows.emplace_back(values[i * 7 % 5]);
+			table.push_back(values[i * 7 % 5]);
+			plain_table.push_back(values[i * 7 % 5]);
+		}
+
+		add("table", "equal filter", "vector<std::string>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::vector<std::uint8_t> mask(strings.size()); for (std::size_t r = 0; r < strings.size(); ++r) { mask[r] = strings[r] == wanted; } do_not_optimize(mask.data()); } });
+		add("table", "equal filter", "vector<hybstr<64>>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::vector<std::uint8_t> mask(rows.size()); for (std::size_t r = 0; r < rows.size(); ++r) { mask[r] = rows[r].view() == wanted; } do_not_optimize(mask.data()); } });
+		add("table", "equal filter", "string_table<64> none", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto mask = plain_table.equal_mask(wanted); do_not_optimize(mask.data()); } });
+		add("table", "equal filter", "string_table<64>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto mask = table.equal_mask(wanted); do_not_optimize(mask.data()); } });
+		add("table", "short filter", "vector<hybstr<64>>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::vector<std::uint8_t> mask(rows.size()); for (std::size_t r = 0; r < rows.size(); ++r) { mask[r] = rows[r].view() == "env=prod"; } do_not_optimize(mask.data()); } });
+		add("table", "short filter", "string_table<64>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto mask = table.equal_mask("env=prod"); do_not_optimize(mask.data()); } });
+		add("table", "hash", "vector<hybstr<64>>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::vector<std::uint64_t> hashes(rows.size()); for (std::size_t r = 0; r < rows.size(); ++r) { hashes[r] = hybstr::hash_value(rows[r]); } do_not_optimize(hashes.data()); } });
+		add("table", "hash", "string_table<64>", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto hashes = table.hash_each(); do_not_optimize(hashes.data()); } });
+#if HYBSTR_HAS_PARALLEL
+		add("table", "equal filter", "string_table<64> par", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto mask = table.equal_mask(std::execution::par_unseq, wanted); do_not_optimize(mask.data()); } });
+		add("table", "hash", "string_table<64> par", Count, [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto hashes = table.hash_each(std::execution::par_unseq); do_not_optimize(hashes.data()); } });
+#endif
+	}
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/** @brief Request-path matching: hybstr::match against std::regex. */
+	inline void register_match()
+	{
+		using namespace hybstr::literals;
+		static const std::string path = "GET /api/orders/12345/lines/7";
+		static const std::regex re("GET /api/([^/]+)/([^/]+)/(.*)");
+
+		add("match", "route", "hybstr::match", path.size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { auto m = hybstr::match<"GET /api/{resource}/{id}/*"_hyb>(path); do_not_optimize(m); } });
+		add("match", "route", "std::regex", path.size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::smatch m; const bool ok = std::regex_match(path, m, re); do_not_optimize(ok); } });
+	}
+
+	/** @brief Longest-prefix dispatch over 32 routes: hybstr::prefix_router against a linear starts_with scan. */
+	inline void register_router()
+	{
+		using namespace hybstr::literals;
+		using router = hybstr::prefix_router<"/api/v1/users/"_hyb, "/api/v2/users/"_hyb, "/api/v1/orders/"_hyb, "/api/v2/orders/"_hyb, "/api/v1/products/"_hyb, "/api/v2/products/"_hyb, "/api/v1/carts/"_hyb, "/api/v2/carts/"_hyb, "/api/v1/payments/"_hyb, "/api/v2/payments/"_hyb, "/api/v1/invoices/"_hyb, "/api/v2/invoices/"_hyb, "/api/v1/search/"_hyb, "/api/v2/search/"_hyb, "/api/v1/sessions/"_hyb, "/api/v2/sessions/"_hyb, "/static/css/"_hyb, "/static/js/"_hyb, "/static/img/"_hyb, "/static/"_hyb, "/health"_hyb, "/metrics"_hyb, "/admin/"_hyb, "/admin/users/"_hyb, "/login"_hyb, "/logout"_hyb, "/docs/"_hyb, "/docs/api/"_hyb, "/assets/"_hyb, "/favicon.ico"_hyb, "/api/"_hyb, "/api/v2/"_hyb>;
+		static const std::vector<std::string_view> routes{ "/api/v1/users/", "/api/v2/users/", "/api/v1/orders/", "/api/v2/orders/", "/api/v1/products/", "/api/v2/products/", "/api/v1/carts/", "/api/v2/carts/", "/api/v1/payments/", "/api/v2/payments/", "/api/v1/invoices/", "/api/v2/invoices/", "/api/v1/search/", "/api/v2/search/", "/api/v1/sessions/", "/api/v2/sessions/", "/static/css/", "/static/js/", "/static/img/", "/static/", "/health", "/metrics", "/admin/", "/admin/users/", "/login", "/logout", "/docs/", "/docs/api/", "/assets/", "/favicon.ico", "/api/", "/api/v2/" };
+		static const std::string path = "/api/v2/payments/12345/refunds";
+
+		add("route", "longest prefix", "prefix_router", routes.size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(router::route(path)); } });
+		add("route", "longest prefix", "starts_with scan", routes.size(), [](std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				const std::string_view p = path;
+				std::size_t best = static_cast<std::size_t>(-1);
+				for (std::size_t r = 0; r < routes.size(); ++r)
+				{
+					if (p.substr(0, routes[r].size()) == routes[r] && (best == static_cast<std::size_t>(-1) || routes[r].size() > routes[best].size()))
+					{
+						best = r;
+					}
+				}
+				do_not_optimize(best);
+			}
+		});
+	}
+
+	/** @brief Interning a label that is already present: hybstr::intern_table against a mutex-guarded std::unordered_set. */
+	inline void register_intern()
+	{
+		static hybstr::intern_table table;
+		static std::mutex mutex;
+		static std::unordered_set<std::string, std::hash<std::string>, std::equal_to<>> set;
+		static const std::string label = "tenant-00042";
+		for (int i = 0; i < 1000; ++i)
+		{
+			const std::string s = "tenant-" + std::to_string(100000 + i).substr(1);
+			(void)table.intern(s);
+			set.insert(s);
+		}
+
+		add("intern", "hit", "intern_table", label.size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { do_not_optimize(table.intern(label)); } });
+		add("intern", "hit", "mutex+unordered_set", label.size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::lock_guard<std::mutex> lock(mutex); do_not_optimize(&*set.insert(label).first); } });
+	}
+
+	/** @brief A 32 KiB HTML-like template, built at compile time. */
+	consteval auto compressed_template_text() -> hybstr::string_impl<32768>
+	{
+		hybstr::string_impl<32768> text;
+		std::uint32_t state = 1;
+		while (text.size() + 80 < text.capacity())
+		{
+			state = state * 1103515245u + 12345u;
+			text.append_inplace(std::string_view("<tr><td class=\"name\">{{name}}</td><td class=\"value\">{{value}}</td></tr>\n"));
+			text.push_back_inplace(static_cast<char>('a' + (state >> 20) % 26));
+		}
+		return text;
+	}
+
+	/** @brief Decompressing a compressed_string against copying the same characters stored plainly. */
+	inline void register_compressed()
+	{
+		static constexpr auto text = compressed_template_text();
+		using blob = hybstr::compressed_string<text>;
+		static std::vector<char> out(blob::size());
+
+		add("compressed", "decode", "copy_to", blob::size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { blob::copy_to(out.data()); do_not_optimize(out[0]); } });
+		add("compressed", "decode", "stream", blob::size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::size_t total = 0; blob::stream([&](std::string_view chunk) { total += chunk.size(); }); do_not_optimize(total); } });
+		add("compressed", "decode", "memcpy (uncompressed)", blob::size(), [](std::size_t n) { for (std::size_t i = 0; i < n; ++i) { std::memcpy(out.data(), text.data(), text.size()); do_not_optimize(out[0]); } });
+	}
+#endif
+
+	// ======================================================================
+	//                           Output
+	// ======================================================================
+
+	inline auto json_escape(const std::string& s) -> std::string
+	{
+		std::string out;
+		for (const char c : s)
+		{
+			if (c == '"' || c == '\\')
+			{
+				out += '\\';
+			}
+			out += c;
+		}
+		return out;
+	}
+
+	inline void write_json(const std::vector<result>& results, const char* path)
+	{
+		std::ofstream out(path);
+		out << "{\n  \"compiler\": \"" << json_escape(
+#if defined(__clang__)
+			"clang " __clang_version__
+#elif defined(__GNUC__)
+			"gcc " __VERSION__
+#elif defined(_MSC_VER)
+			"msvc " + std::to_string(_MSC_VER)
+#else
+			"unknown"
+#endif
+		) << "\",\n  \"cplusplus\": " << HYBSTR_CPP_STD << ",\n  \"benchmarks\": [\n";
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			const result& r = results[i];
+			out << "    { \"group\": \"" << json_escape(r.bench->group) << "\", \"name\": \"" << json_escape(r.bench->name)
+				<< "\", \"impl\": \"" << json_escape(r.bench->impl) << "\", \"size\": " << r.bench->size
+				<< ", \"ns_per_op\": " << r.ns_per_op << ", \"iterations\": " << r.iterations << " }"
+				<< (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		out << "  ]\n}\n";
+	}
+} // namespace bench
+
+int main(int argc, char** argv)
+{
+	const char* filter = nullptr;
+	const char* json = nullptr;
+	long min_time_ms = 20;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		const std::string_view arg = argv[i];
+		if (arg == "--filter") filter = argv[i + 1];
+		else if (arg == "--json") json = argv[i + 1];
+		else if (arg == "--min-time") min_time_ms = std::atol(argv[i + 1]);
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--filter <substring>] [--min-time <ms>] [--json <file>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	bench::register_size<8, 16>();
+	bench::register_size<64, 128>();
+	bench::register_size<512, 1024>();
+	bench::register_big<16, 4096>();
+	bench::register_big<16, 100000>();
+	bench::register_big<4000, 100000>();
+	bench::register_sort<100000>();
+	bench::register_table<1000000>();
+#if HYBSTR_CPP_20_OR_ABOVE
+	bench::register_match();
+	bench::register_router();
+	bench::register_intern();
+	bench::register_compressed();
+#endif
+
+	std::vector<bench::result> results;
+	std::printf("%-15s %-20s %-22s %6s %12s\n", "group", "name", "impl", "size", "ns/op");
+	for (const bench::benchmark& b : bench::registry())
+	{
+		const std::string id = b.group + "/" + b.name + "/" + b.impl + "/" + std::to_string(b.size);
+		if (filter && id.find(filter) == std::string::npos)
+		{
+			continue;
+		}
+		results.push_back(bench::measure(b, std::chrono::milliseconds(min_time_ms)));
+		std::printf("%-15s %-20s %-22s %6zu %12.2f\n", b.group.c_str(), b.name.c_str(), b.impl.c_str(), b.size, results.back().ns_per_op);
+	}
+
+	if (json)
+	{
+		bench::write_json(results, json);
+	}
+	return 0;
+}
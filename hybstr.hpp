@@ -24,13 +24,26 @@
 #pragma once
 
 #include <array>
+#include <tuple>
+#include <deque>
+#include <mutex>
+#include <iosfwd>
 #include <string>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <utility>
+#include <iterator>
+#include <charconv>
 #include <optional>
 #include <algorithm>
 #include <stdexcept>
+#include <functional>
 #include <string_view>
 #include <type_traits>
 
@@ -69,916 +82,8116 @@
 	#define HYBSTR_IS_CONSTANT_EVALUATED false
 #endif
 
+#if !defined(HYBSTR_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define HYBSTR_HAS_SSE2 true
+	#include <emmintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+	#endif
+#else
+	#define HYBSTR_HAS_SSE2 false
+#endif
+
+// Runtime kernels with loops (searching, case mapping, UTF-8 scans, hashing of long inputs) are kept out of
+// line, so that every string_impl instantiation calls one shared copy. Define HYBSTR_INLINE_KERNELS to let
+// the compiler inline them at each call site instead.
+#ifndef HYBSTR_NOINLINE
+	#if defined(HYBSTR_INLINE_KERNELS)
+		#define HYBSTR_NOINLINE
+	#elif defined(_MSC_VER) && !defined(__clang__)
+		#define HYBSTR_NOINLINE __declspec(noinline)
+	#elif defined(__GNUC__) || defined(__clang__)
+		#define HYBSTR_NOINLINE __attribute__((noinline))
+	#else
+		#define HYBSTR_NOINLINE
+	#endif
+#endif
+
+// std::formatter specializations, when the standard library has <format>. Define HYBSTR_NO_STD_FORMAT to skip them.
+#if HYBSTR_CPP_20_OR_ABOVE && !defined(HYBSTR_NO_STD_FORMAT) && __has_include(<format>)
+	#include <version>
+	#if defined(__cpp_lib_format)
+		#define HYBSTR_HAS_STD_FORMAT true
+		#include <format>
+	#endif
+#endif
+#ifndef HYBSTR_HAS_STD_FORMAT
+	#define HYBSTR_HAS_STD_FORMAT false
+#endif
+
+// 'iovec' output for writev / sendmsg on POSIX systems.
+#if defined(__has_include)
+	#if __has_include(<sys/uio.h>)
+		#define HYBSTR_HAS_IOVEC true
+		#include <sys/uio.h>
+	#endif
+#endif
+#ifndef HYBSTR_HAS_IOVEC
+	#define HYBSTR_HAS_IOVEC false
+#endif
+
+// Opt-in runtime counters (truncations, overflows, bytes copied, capacity use), read with hybstr::stats().
+#if defined(HYBSTR_STATS)
+	#define HYBSTR_HAS_STATS true
+#else
+	#define HYBSTR_HAS_STATS false
+#endif
+
+// Execution policy overloads of the string_table batch operations. Opt-in with HYBSTR_PARALLEL, since the
+// standard library may need its parallel backend linked (TBB for libstdc++).
+#if defined(HYBSTR_PARALLEL) && defined(__has_include)
+	#if __has_include(<execution>)
+		#include <execution>
+		#if defined(__cpp_lib_execution)
+			#define HYBSTR_HAS_PARALLEL true
+		#endif
+	#endif
+#endif
+#ifndef HYBSTR_HAS_PARALLEL
+	#define HYBSTR_HAS_PARALLEL false
+#endif
+
 /**
  * @namespace hybstr
  * @brief Main interface
  */
 namespace hybstr
 {
-	template<std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY>
-	[[nodiscard]] constexpr auto string();
-	template<std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
-		std::size_t N>
-	[[nodiscard]] constexpr auto string(const char(&str)[N]);
-	template<std::size_t ViewSize = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
-		std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY>
-	[[nodiscard]] constexpr auto string(std::string_view sv) noexcept;
-	template<std::size_t RangeSize = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
-		std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
-		typename _Iter>
-	[[nodiscard]] constexpr auto string(_Iter start, _Iter end) noexcept;
+	// ======================================================================
+	//                           Kernels
+	// ======================================================================
 
 	/**
-	 * @brief Fixed-capacity string that will expand on demand.
-	 *
-	 * @tparam BufferCapacity Number of characters stored in the compile-time buffer (excluding the null terminator).
-	 * @tparam DynamicExpandCapacity Size of the dynamic buffer allocated for runtime operations.
-	 *
-	 * @details
-	 * Combines a compile-time buffer for constexpr evaluation with a dynamic buffer
-	 * for runtime use.
-	 * 'BufferCapacity' defines how many characters are stored in the fixed buffer,
-	 * and 'DynamicExpandCapacity' specifies the size of the dynamic region used when
-	 * handling inputs such as 'std::string_view' or iterator ranges whose lengths
-	 * cannot be determined at compile time.
-	 * The dynamic buffer size can also be customized through template arguments.
-	 *
-	 * This class is not intended to be used directly.
-	 * Prefer using the factory functions:
-	 * @code
-	 * auto s11 = hybstr::string();               // empty string
-	 * auto s12 = hybstr::string<10>();           // empty string with custom dynamic expand capacity
-	 *
-	 * auto s21 = hybstr::string("abc");          // from string literal
-	 * auto s22 = hybstr::string<10>("abc");      // from literal with custom dynamic expand capacity
-	 *
-	 * constexpr std::string_view sv = "abc";     // non-constexpr string views also work
-	 * auto s31 = hybstr::string<3>(sv);          // from string_view (specify length, default to HYBSTR_DYNAMIC_EXPAND_CAPACITY)
-	 * auto s32 = hybstr::string<3, 10>(sv);      // from string_view with custom expand capacity
-	 *
-	 * std::string str = "Hello world";
-	 * auto s41 = hybstr::string<11>(str.begin(), str.end());        // from iterator range (specify length, default to HYBSTR_DYNAMIC_EXPAND_CAPACITY)
-	 * auto s42 = hybstr::string<11, 10>(str.begin(), str.end());    // from iterator range with custom expand capacity
-	 * @endcode
-	 *
-	 * Example:
-	 * @code
-	 * constexpr auto s1 = std::string_view("Greetings");
-	 * 
-	 * // Constexpr
-	 * constexpr auto s2 = hybstr::string("Name");
-	 * constexpr auto s3 = hybstr::string(s1) + ", " + s2;
-	 * static_assert(s3 == hybstr::string("Greetings, Name"));
-	 * 
-	 * // Run time
-	 * std::string s4;
-	 * std::cin >> s4;
-	 * auto s5 = hybstr::string(s1) + ", " + s4;
-	 * assert(s5.view() == std::string(s1.begin(), s1.end()) + ", " + s4);
-	 * @endcode
+	 * @namespace hybstr::detail
+	 * @brief Implementation details
 	 */
-	template <std::size_t BufferCapacity = 0, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY>
-	class string_impl
+	namespace detail
 	{
-		template <std::size_t, std::size_t>
-		friend class string_impl;
-	public:
-		using value_type = char;
-		using reference = value_type&;
-		using const_reference = const value_type&;
-		using size_type = std::size_t;
-		using view_type = std::string_view;
-		using pointer = char*;
-		using const_pointer = const char*;
-		using iterator = typename std::array<char, BufferCapacity + 1>::iterator;
-		using const_iterator = typename std::array<char, BufferCapacity + 1>::const_iterator;
-		using reverse_iterator = typename std::array<char, BufferCapacity + 1>::reverse_iterator;
-		using const_reverse_iterator = typename std::array<char, BufferCapacity + 1>::const_reverse_iterator;
+		/*
+		 * Character kernels shared by every operation.
+		 * Constant evaluation runs plain loops; at runtime they forward to the C library,
+		 * whose memcpy / memmove / memset / memcmp are vectorized for the target (SSE2, AVX2, NEON, ...).
+		 * Kernels with loops of their own keep their runtime path in a non-template '*_runtime'
+		 * function marked HYBSTR_NOINLINE; the constexpr wrappers only pick the path.
+		 */
 
-		/** @brief Default constructor. Initializes an empty string. */
-		constexpr string_impl() noexcept
-			: _size(0)
+		/** @brief Copies @p n characters. The ranges must not overlap. */
+		constexpr void copy_chars(char* out, const char* in, std::size_t n) noexcept
+		{
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					out[i] = in[i];
+				}
+			}
+			else if (n != 0)
+			{
+				std::memcpy(out, in, n);
+			}
+		}
+
+		/** @brief Copies @p n characters. The ranges may overlap if @p out precedes @p in. */
+		constexpr void move_chars(char* out, const char* in, std::size_t n) noexcept
 		{
-			_data[0] = '\0';
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					out[i] = in[i];
+				}
+			}
+			else if (n != 0)
+			{
+				std::memmove(out, in, n);
+			}
 		}
 
-		/**
-		 * @brief Constructs from a string literal.
-		 * @tparam N Number of characters including null terminator.
-		 * @param str Null-terminated C-style string.
-		 */
-		template <std::size_t N>
-		constexpr string_impl(const char(&str)[N]) noexcept
+		/** @brief Writes @p n copies of @p c. */
+		constexpr void fill_chars(char* out, char c, std::size_t n) noexcept
 		{
-			static_assert(N > 0 && N - 1 <= BufferCapacity, "string literal too long");
-			for (std::size_t i = 0; i < N - 1; ++i)
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					out[i] = c;
+				}
+			}
+			else if (n != 0)
 			{
-				_data[i] = str[i];
+				std::memset(out, static_cast<unsigned char>(c), n);
 			}
-			_data[N - 1] = '\0';
-			_size = N - 1;
 		}
 
 		/**
-		 * @brief Fills the buffer with a repeated character.
-		 * @param n Number of characters to fill.
-		 * @param c Fill character.
+		 * @brief Lexicographically compares @p n characters as unsigned bytes (like 'std::char_traits<char>').
+		 * @return Negative, zero or positive.
 		 */
-		constexpr string_impl(const std::size_t& n, char c) noexcept
+		constexpr auto compare_chars(const char* a, const char* b, std::size_t n) noexcept -> int
+		{
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					const auto ca = static_cast<unsigned char>(a[i]);
+					const auto cb = static_cast<unsigned char>(b[i]);
+					if (ca != cb)
+					{
+						return ca < cb ? -1 : 1;
+					}
+				}
+				return 0;
+			}
+			return n == 0 ? 0 : std::memcmp(a, b, n);
+		}
+
+		/** @brief True if the @p n characters at @p a and @p b are equal. */
+		constexpr auto equal_chars(const char* a, const char* b, std::size_t n) noexcept -> bool
+		{
+			return compare_chars(a, b, n) == 0;
+		}
+
+		/** @brief Smallest power of two not less than @p n (1 for 0). */
+		constexpr auto bit_ceil(std::size_t n) noexcept -> std::size_t
 		{
-			const std::size_t len = std::min(n, BufferCapacity);
-			for (std::size_t i = 0; i < len; ++i)
+			std::size_t r = 1;
+			while (r < n)
+			{
+				r <<= 1;
+			}
+			return r;
+		}
+
+		/** @brief The 8 characters at @p p as a big-endian integer, so that integer order is byte order. */
+		constexpr auto load_be64(const char* p) noexcept -> std::uint64_t
+		{
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && HYBSTR_HAS_SSE2)
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				std::uint64_t word = 0;
+				std::memcpy(&word, p, sizeof(word));
+#if defined(_MSC_VER) && !defined(__clang__)
+				return _byteswap_uint64(word);
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+				return word;
+#else
+				return __builtin_bswap64(word);
+#endif
+			}
+#endif
+			std::uint64_t word = 0;
+			for (std::size_t i = 0; i < 8; ++i)
 			{
-				_data[i] = c;
+				word = (word << 8) | static_cast<unsigned char>(p[i]);
 			}
-			_data[len] = '\0';
-			_size = len;
+			return word;
 		}
 
 		/**
-		 * @brief Constructs from a std::string_view.
-		 * Copies up to BufferCapacity characters.
+		 * @brief Big-endian value of the characters [@p offset, @p offset + 8) of the @p n at @p p,
+		 * with the bytes past the end as zero.
+		 *
+		 * @details
+		 * Unequal keys order two strings like 'compare_chars' followed by the size (a byte past the end
+		 * only ever ties with a '\0' or loses to any other character). Equal keys leave the decision
+		 * to the characters from @p offset + 8 on, or to the sizes when either string ends first.
 		 */
-		constexpr string_impl(std::string_view sv) noexcept
+		constexpr auto prefix_key(const char* p, std::size_t n, std::size_t offset) noexcept -> std::uint64_t
 		{
-			const std::size_t len = std::min(sv.size(), BufferCapacity);
-			for (std::size_t i = 0; i < len; ++i)
+			if (offset >= n)
+			{
+				return 0;
+			}
+			if (n - offset >= 8)
+			{
+				return load_be64(p + offset);
+			}
+			std::uint64_t key = 0;
+			for (std::size_t i = 0; offset + i < n; ++i)
 			{
-				_data[i] = sv[i];
+				key |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[offset + i])) << (56 - 8 * i);
 			}
-			_data[len] = '\0';
-			_size = len;
+			return key;
+		}
+
+		/*
+		 * Search kernels. Positions follow std::string: @p pos is where the search starts,
+		 * and npos is returned when nothing is found.
+		 */
+
+		/// @brief "Not found" position returned by the search kernels.
+		inline constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+#if HYBSTR_HAS_SSE2
+		/** @brief Index of the lowest set bit of a non-zero @p mask. */
+		inline auto lowest_bit(unsigned mask) noexcept -> unsigned
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long i;
+			_BitScanForward(&i, mask);
+			return static_cast<unsigned>(i);
+#else
+			return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
 		}
+#endif
 
 		/**
-		 * @brief Constructs from an iterator range.
-		 * Copies until 'end' or until BufferCapacity is reached.
+		 * @brief Runtime substring search for needles of two characters or more, starting at @p pos.
+		 *
+		 * @details
+		 * Candidates are filtered on the first and last needle characters, 16 positions at a time with SSE2,
+		 * then with memchr for the tail. Only candidates passing both checks are compared in full.
 		 */
-		template<typename _Iter>
-		constexpr string_impl(_Iter start, _Iter end) noexcept
+		HYBSTR_NOINLINE inline auto find_chars_runtime(const char* hay, std::size_t n, const char* needle, std::size_t m, std::size_t pos) noexcept -> std::size_t
 		{
-			std::size_t i = 0;
+			const char first = needle[0];
+			const char last = needle[m - 1];
+			std::size_t i = pos;
+#if HYBSTR_HAS_SSE2
+			const __m128i first_block = _mm_set1_epi8(first);
+			const __m128i last_block = _mm_set1_epi8(last);
+			for (; i + m + 15 <= n; i += 16)
+			{
+				const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+				const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + m - 1));
+				unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+					_mm_and_si128(_mm_cmpeq_epi8(head, first_block), _mm_cmpeq_epi8(tail, last_block))));
+				while (mask != 0)
+				{
+					const std::size_t candidate = i + lowest_bit(mask);
+					if (std::memcmp(hay + candidate + 1, needle + 1, m - 2) == 0)
+					{
+						return candidate;
+					}
+					mask &= mask - 1;
+				}
+			}
+#endif
+			const std::size_t end = n - m + 1;
+			while (i < end)
+			{
+				const void* found = std::memchr(hay + i, first, end - i);
+				if (!found)
+				{
+					return npos;
+				}
+				i = static_cast<std::size_t>(static_cast<const char*>(found) - hay);
+				if (hay[i + m - 1] == last && std::memcmp(hay + i + 1, needle + 1, m - 2) == 0)
+				{
+					return i;
+				}
+				++i;
+			}
+			return npos;
+		}
 
-			while (i < BufferCapacity && start != end)
+		/** @brief Position of the first @p c in @p hay at or after @p pos. */
+		constexpr auto find_char(const char* hay, std::size_t n, char c, std::size_t pos) noexcept -> std::size_t
+		{
+			if (pos >= n)
+			{
+				return npos;
+			}
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				for (std::size_t i = pos; i < n; ++i)
+				{
+					if (hay[i] == c)
+					{
+						return i;
+					}
+				}
+				return npos;
+			}
+			const void* found = std::memchr(hay + pos, c, n - pos);
+			return found ? static_cast<std::size_t>(static_cast<const char*>(found) - hay) : npos;
+		}
+
+		/** @brief Position of the first occurrence of @p needle in @p hay at or after @p pos. */
+		constexpr auto find_chars(const char* hay, std::size_t n, const char* needle, std::size_t m, std::size_t pos) noexcept -> std::size_t
+		{
+			if (pos > n || m > n - pos)
+			{
+				return npos;
+			}
+			if (m == 0)
+			{
+				return pos;
+			}
+			if (m == 1)
+			{
+				return find_char(hay, n, needle[0], pos);
+			}
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
 			{
-				_data[i++] = *(start++);
+				for (std::size_t i = pos; i + m <= n; ++i)
+				{
+					if (equal_chars(hay + i, needle, m))
+					{
+						return i;
+					}
+				}
+				return npos;
 			}
+			return find_chars_runtime(hay, n, needle, m, pos);
+		}
 
-			_data[i] = '\0';
-			_size = i;
+		/** @brief Runtime part of 'rfind_chars'. */
+		HYBSTR_NOINLINE inline auto rfind_chars_runtime(const char* hay, std::size_t n, const char* needle, std::size_t m, std::size_t pos) noexcept -> std::size_t
+		{
+			if (m > n)
+			{
+				return npos;
+			}
+			for (std::size_t i = std::min(pos, n - m) + 1; i-- > 0;)
+			{
+				if (m == 0 || (hay[i] == needle[0] && hay[i + m - 1] == needle[m - 1] && std::memcmp(hay + i, needle, m) == 0))
+				{
+					return i;
+				}
+			}
+			return npos;
 		}
 
-		constexpr string_impl(const string_impl&) noexcept = default;
-		constexpr string_impl(string_impl&&) noexcept = default;
-		constexpr string_impl& operator=(const string_impl&) noexcept = default;
-		constexpr string_impl& operator=(string_impl&&) noexcept = default;
+		/** @brief Position of the last occurrence of @p needle in @p hay starting at or before @p pos. */
+		constexpr auto rfind_chars(const char* hay, std::size_t n, const char* needle, std::size_t m, std::size_t pos) noexcept -> std::size_t
+		{
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				return rfind_chars_runtime(hay, n, needle, m, pos);
+			}
+			if (m > n)
+			{
+				return npos;
+			}
+			for (std::size_t i = std::min(pos, n - m) + 1; i-- > 0;)
+			{
+				if (m == 0 || (hay[i] == needle[0] && hay[i + m - 1] == needle[m - 1] && equal_chars(hay + i, needle, m)))
+				{
+					return i;
+				}
+			}
+			return npos;
+		}
 
-		/** @return Number of characters currently stored. */
-		[[nodiscard]] constexpr auto size() const noexcept -> size_type
+		/** @brief 256-bit membership table for the character set searches. */
+		struct byte_set
 		{
-			return _size;
+			constexpr byte_set() noexcept = default;
+			constexpr byte_set(const char* chars, std::size_t n) noexcept
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					insert(chars[i]);
+				}
+			}
+
+			constexpr void insert(char ch) noexcept
+			{
+				const auto c = static_cast<unsigned char>(ch);
+				_bits[c >> 6] |= std::uint64_t{ 1 } << (c & 63);
+			}
+
+			[[nodiscard]] constexpr auto contains(char ch) const noexcept -> bool
+			{
+				const auto c = static_cast<unsigned char>(ch);
+				return (_bits[c >> 6] >> (c & 63)) & 1;
+			}
+
+			std::array<std::uint64_t, 4> _bits{};
+		};
+
+		/** @brief Runtime part of 'find_of_chars'. */
+		template<bool Member>
+		HYBSTR_NOINLINE inline auto find_of_chars_runtime(const char* hay, std::size_t n, const char* set, std::size_t k, std::size_t pos) noexcept -> std::size_t
+		{
+			if (Member && k == 1)
+			{
+				return find_char(hay, n, set[0], pos);
+			}
+			const byte_set table(set, k);
+			for (std::size_t i = pos; i < n; ++i)
+			{
+				if (table.contains(hay[i]) == Member)
+				{
+					return i;
+				}
+			}
+			return npos;
+		}
+
+		/** @brief Position of the first character at or after @p pos that is (@p Member) or is not in @p set. */
+		template<bool Member>
+		constexpr auto find_of_chars(const char* hay, std::size_t n, const char* set, std::size_t k, std::size_t pos) noexcept -> std::size_t
+		{
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				return find_of_chars_runtime<Member>(hay, n, set, k, pos);
+			}
+			const byte_set table(set, k);
+			for (std::size_t i = pos; i < n; ++i)
+			{
+				if (table.contains(hay[i]) == Member)
+				{
+					return i;
+				}
+			}
+			return npos;
+		}
+
+		/** @brief Runtime part of 'rfind_of_chars'. */
+		template<bool Member>
+		HYBSTR_NOINLINE inline auto rfind_of_chars_runtime(const char* hay, std::size_t n, const char* set, std::size_t k, std::size_t pos) noexcept -> std::size_t
+		{
+			if (n == 0)
+			{
+				return npos;
+			}
+			const byte_set table(set, k);
+			for (std::size_t i = std::min(pos, n - 1) + 1; i-- > 0;)
+			{
+				if (table.contains(hay[i]) == Member)
+				{
+					return i;
+				}
+			}
+			return npos;
+		}
+
+		/** @brief Position of the last character at or before @p pos that is (@p Member) or is not in @p set. */
+		template<bool Member>
+		constexpr auto rfind_of_chars(const char* hay, std::size_t n, const char* set, std::size_t k, std::size_t pos) noexcept -> std::size_t
+		{
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				return rfind_of_chars_runtime<Member>(hay, n, set, k, pos);
+			}
+			if (n == 0)
+			{
+				return npos;
+			}
+			const byte_set table(set, k);
+			for (std::size_t i = std::min(pos, n - 1) + 1; i-- > 0;)
+			{
+				if (table.contains(hay[i]) == Member)
+				{
+					return i;
+				}
+			}
+			return npos;
+		}
+
+		/*
+		 * ASCII transform kernels. Only the bytes 'A'-'Z' and 'a'-'z' are ever changed; every
+		 * other byte, including UTF-8 sequences, passes through untouched. Runtime paths work on
+		 * 16 bytes with SSE2, then on 8-byte words (SWAR), then finish byte by byte.
+		 */
+
+		/// @brief Characters removed by trim(): space, \\t, \\n, \\v, \\f and \\r.
+		inline constexpr char ascii_whitespace[] = " \t\n\v\f\r";
+
+		/** @brief @p sv without leading (@p Left) and trailing (@p Right) ASCII whitespace. */
+		template<bool Left, bool Right>
+		constexpr auto trim_view(std::string_view sv) noexcept -> std::string_view
+		{
+			std::size_t first = 0;
+			std::size_t last = sv.size();
+			if constexpr (Left)
+			{
+				first = find_of_chars<false>(sv.data(), sv.size(), ascii_whitespace, sizeof(ascii_whitespace) - 1, 0);
+				if (first == npos)
+				{
+					return sv.substr(sv.size());
+				}
+			}
+			if constexpr (Right)
+			{
+				const std::size_t back = rfind_of_chars<false>(sv.data(), sv.size(), ascii_whitespace, sizeof(ascii_whitespace) - 1, npos);
+				last = back == npos ? first : back + 1;
+			}
+			return sv.substr(first, last - first);
+		}
+
+		/** @brief ASCII lower case of @p c. */
+		constexpr auto ascii_lower(char c) noexcept -> char
+		{
+			return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+		}
+
+		/** @brief @p c repeated in every byte of a 64-bit word. */
+		constexpr auto broadcast_byte(unsigned char c) noexcept -> std::uint64_t
+		{
+			return 0x0101010101010101ull * c;
+		}
+
+		/** @brief 0x20 in every byte of @p word lying in [@p first, @p last], zero elsewhere. Both bounds must be ASCII. */
+		constexpr auto swar_range_flip(std::uint64_t word, char first, char last) noexcept -> std::uint64_t
+		{
+			const std::uint64_t high = broadcast_byte(0x80);
+			const std::uint64_t low7 = word & ~high;
+			// Neither sum carries into the next byte; the high bit tells whether the byte reached the bound.
+			const std::uint64_t at_least_first = low7 + broadcast_byte(static_cast<unsigned char>(0x80 - first));
+			const std::uint64_t above_last = low7 + broadcast_byte(static_cast<unsigned char>(0x7F - last));
+			return ((at_least_first ^ above_last) & ~word & high) >> 2;
+		}
+
+		/** @brief 0xFF in every byte of @p word equal to @p c, zero elsewhere. */
+		constexpr auto swar_equal_mask(std::uint64_t word, char c) noexcept -> std::uint64_t
+		{
+			const std::uint64_t low7 = broadcast_byte(0x7F);
+			const std::uint64_t x = word ^ broadcast_byte(static_cast<unsigned char>(c));
+			const std::uint64_t zero = ~(((x & low7) + low7) | x | low7);
+			return (zero >> 7) * 0xFF;
+		}
+
+#if HYBSTR_HAS_SSE2
+		/** @brief Flips the case of every byte of @p block in [@p lo + 1, @p hi - 1]. */
+		inline auto sse2_range_flip(__m128i block, __m128i lo, __m128i hi) noexcept -> __m128i
+		{
+			const __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(block, lo), _mm_cmplt_epi8(block, hi));
+			return _mm_xor_si128(block, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+		}
+#endif
+
+		/** @brief Runtime part of 'flip_case_chars'. */
+		template<char First, char Last>
+		HYBSTR_NOINLINE inline void flip_case_runtime(char* out, const char* in, std::size_t n) noexcept
+		{
+			std::size_t i = 0;
+#if HYBSTR_HAS_SSE2
+			const __m128i lo = _mm_set1_epi8(static_cast<char>(First - 1));
+			const __m128i hi = _mm_set1_epi8(static_cast<char>(Last + 1));
+			for (; i + 16 <= n; i += 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), sse2_range_flip(block, lo, hi));
+			}
+#endif
+			for (; i + 8 <= n; i += 8)
+			{
+				std::uint64_t word = 0;
+				std::memcpy(&word, in + i, 8);
+				word ^= swar_range_flip(word, First, Last);
+				std::memcpy(out + i, &word, 8);
+			}
+			for (; i < n; ++i)
+			{
+				const char c = in[i];
+				out[i] = (c >= First && c <= Last) ? static_cast<char>(c ^ 0x20) : c;
+			}
+		}
+
+		/**
+		 * @brief Writes @p n characters of @p in to @p out, flipping the case of letters in [First, Last].
+		 * @p out may equal @p in.
+		 */
+		template<char First, char Last>
+		constexpr void flip_case_chars(char* out, const char* in, std::size_t n) noexcept
+		{
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				flip_case_runtime<First, Last>(out, in, n);
+				return;
+			}
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				const char c = in[i];
+				out[i] = (c >= First && c <= Last) ? static_cast<char>(c ^ 0x20) : c;
+			}
+		}
+
+		/** @brief Runtime part of 'replace_char'. */
+		HYBSTR_NOINLINE inline void replace_char_runtime(char* out, const char* in, std::size_t n, char from, char to) noexcept
+		{
+			std::size_t i = 0;
+#if HYBSTR_HAS_SSE2
+			const __m128i from_block = _mm_set1_epi8(from);
+			const __m128i to_block = _mm_set1_epi8(to);
+			for (; i + 16 <= n; i += 16)
+			{
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				const __m128i hit = _mm_cmpeq_epi8(block, from_block);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+					_mm_or_si128(_mm_andnot_si128(hit, block), _mm_and_si128(hit, to_block)));
+			}
+#endif
+			const std::uint64_t to_word = broadcast_byte(static_cast<unsigned char>(to));
+			for (; i + 8 <= n; i += 8)
+			{
+				std::uint64_t word = 0;
+				std::memcpy(&word, in + i, 8);
+				const std::uint64_t hit = swar_equal_mask(word, from);
+				word = (word & ~hit) | (to_word & hit);
+				std::memcpy(out + i, &word, 8);
+			}
+			for (; i < n; ++i)
+			{
+				out[i] = in[i] == from ? to : in[i];
+			}
+		}
+
+		/** @brief Writes @p n characters of @p in to @p out with every @p from replaced by @p to. @p out may equal @p in. */
+		constexpr void replace_char(char* out, const char* in, std::size_t n, char from, char to) noexcept
+		{
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				replace_char_runtime(out, in, n, from, to);
+				return;
+			}
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				out[i] = in[i] == from ? to : in[i];
+			}
+		}
+
+		/**
+		 * @brief Runtime part of 'iequal_prefix'.
+		 * Blocks are compared whole; the scalar tail pins down the exact mismatch.
+		 */
+		HYBSTR_NOINLINE inline auto iequal_prefix_runtime(const char* a, const char* b, std::size_t n) noexcept -> std::size_t
+		{
+			std::size_t i = 0;
+#if HYBSTR_HAS_SSE2
+			const __m128i lo = _mm_set1_epi8('A' - 1);
+			const __m128i hi = _mm_set1_epi8('Z' + 1);
+			for (; i + 16 <= n; i += 16)
+			{
+				const __m128i x = sse2_range_flip(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), lo, hi);
+				const __m128i y = sse2_range_flip(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)), lo, hi);
+				const unsigned diff = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) ^ 0xFFFFu;
+				if (diff != 0)
+				{
+					return i + lowest_bit(diff);
+				}
+			}
+#endif
+			for (; i + 8 <= n; i += 8)
+			{
+				std::uint64_t x = 0;
+				std::uint64_t y = 0;
+				std::memcpy(&x, a + i, 8);
+				std::memcpy(&y, b + i, 8);
+				if ((x ^ swar_range_flip(x, 'A', 'Z')) != (y ^ swar_range_flip(y, 'A', 'Z')))
+				{
+					break;
+				}
+			}
+			for (; i < n; ++i)
+			{
+				if (ascii_lower(a[i]) != ascii_lower(b[i]))
+				{
+					break;
+				}
+			}
+			return i;
+		}
+
+		/** @brief Length of the leading run of @p n characters that are equal ignoring ASCII case. */
+		constexpr auto iequal_prefix(const char* a, const char* b, std::size_t n) noexcept -> std::size_t
+		{
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				return iequal_prefix_runtime(a, b, n);
+			}
+			std::size_t i = 0;
+			while (i < n && ascii_lower(a[i]) == ascii_lower(b[i]))
+			{
+				++i;
+			}
+			return i;
+		}
+
+		/** @brief Three-way comparison ignoring ASCII case; bytes are compared as unsigned char. */
+		constexpr auto icompare_chars(const char* a, std::size_t n, const char* b, std::size_t m) noexcept -> int
+		{
+			const std::size_t common = std::min(n, m);
+			const std::size_t i = iequal_prefix(a, b, common);
+			if (i < common)
+			{
+				return static_cast<unsigned char>(ascii_lower(a[i])) < static_cast<unsigned char>(ascii_lower(b[i])) ? -1 : 1;
+			}
+			return n == m ? 0 : (n < m ? -1 : 1);
+		}
+	} // namespace detail
+
+	// ======================================================================
+	//                           Statistics
+	// ======================================================================
+
+	namespace detail
+	{
+		/** @brief Where a runtime construction came from. */
+		enum class construct_site
+		{
+			view,
+			range,
+			fill,
+			concat
+		};
+	} // namespace detail
+
+#if HYBSTR_HAS_STATS
+	/**
+	 * @brief Counters collected when HYBSTR_STATS is defined. Only runtime operations are counted.
+	 *
+	 * @details
+	 * The histogram and the waste total cover the runtime string_view, iterator, fill and concatenation
+	 * constructors, which are where a too small or too large per-site capacity shows up.
+	 */
+	struct stats_snapshot
+	{
+		std::uint64_t view_truncations = 0;            ///< string_view constructions that dropped characters.
+		std::uint64_t range_truncations = 0;           ///< Iterator-range constructions that stopped before 'end'.
+		std::uint64_t fill_truncations = 0;            ///< string_impl(n, c) constructions that dropped characters.
+		std::uint64_t concat_truncations = 0;          ///< Materialized concatenations that dropped characters.
+		std::uint64_t truncated_chars = 0;             ///< Characters dropped by the string_view, fill and concatenation constructors.
+		std::uint64_t near_limit_appends = 0;          ///< append<TargetSize>(std::string_view) calls using more than 3/4 of TargetSize.
+		std::uint64_t overflows = 0;                   ///< In-place appends handed to the overflow policy.
+		std::uint64_t bytes_copied = 0;                ///< Characters copied by operator+, append, append_inplace, resize and reserve.
+		std::uint64_t constructions = 0;               ///< Constructions counted in fill_histogram.
+		std::uint64_t wasted_bytes = 0;                ///< Sum of capacity() - size() over them.
+		std::array<std::uint64_t, 8> fill_histogram{}; ///< Bucket i: size() in [i/8, (i+1)/8) of capacity(). Full strings land in the last one.
+	};
+
+	namespace detail
+	{
+		/** @brief Process-wide counters, updated with relaxed atomics so any thread may read them. */
+		struct stats_counters
+		{
+			std::atomic<std::uint64_t> view_truncations{ 0 };
+			std::atomic<std::uint64_t> range_truncations{ 0 };
+			std::atomic<std::uint64_t> fill_truncations{ 0 };
+			std::atomic<std::uint64_t> concat_truncations{ 0 };
+			std::atomic<std::uint64_t> truncated_chars{ 0 };
+			std::atomic<std::uint64_t> near_limit_appends{ 0 };
+			std::atomic<std::uint64_t> overflows{ 0 };
+			std::atomic<std::uint64_t> bytes_copied{ 0 };
+			std::atomic<std::uint64_t> constructions{ 0 };
+			std::atomic<std::uint64_t> wasted_bytes{ 0 };
+			std::array<std::atomic<std::uint64_t>, 8> fill_histogram{};
+		};
+
+		inline stats_counters global_stats;
+
+		inline void stats_add(std::atomic<std::uint64_t>& counter, std::uint64_t n) noexcept
+		{
+			counter.fetch_add(n, std::memory_order_relaxed);
+		}
+
+		inline void stats_construct_runtime(construct_site site, std::size_t requested, std::size_t kept, std::size_t capacity) noexcept
+		{
+			stats_counters& s = global_stats;
+			if (kept < requested)
+			{
+				switch (site)
+				{
+				case construct_site::view: stats_add(s.view_truncations, 1); break;
+				case construct_site::range: stats_add(s.range_truncations, 1); break;
+				case construct_site::fill: stats_add(s.fill_truncations, 1); break;
+				case construct_site::concat: stats_add(s.concat_truncations, 1); break;
+				}
+				if (site != construct_site::range)
+				{
+					stats_add(s.truncated_chars, requested - kept);
+				}
+			}
+			stats_add(s.constructions, 1);
+			stats_add(s.wasted_bytes, capacity - kept);
+			stats_add(s.fill_histogram[capacity == 0 ? 7 : std::min<std::size_t>(7, kept * 8 / capacity)], 1);
+		}
+	} // namespace detail
+
+	/** @return A copy of the counters. Safe to call from any thread while strings are in use. */
+	[[nodiscard]] inline auto stats() noexcept -> stats_snapshot
+	{
+		const detail::stats_counters& s = detail::global_stats;
+		stats_snapshot out;
+		out.view_truncations = s.view_truncations.load(std::memory_order_relaxed);
+		out.range_truncations = s.range_truncations.load(std::memory_order_relaxed);
+		out.fill_truncations = s.fill_truncations.load(std::memory_order_relaxed);
+		out.concat_truncations = s.concat_truncations.load(std::memory_order_relaxed);
+		out.truncated_chars = s.truncated_chars.load(std::memory_order_relaxed);
+		out.near_limit_appends = s.near_limit_appends.load(std::memory_order_relaxed);
+		out.overflows = s.overflows.load(std::memory_order_relaxed);
+		out.bytes_copied = s.bytes_copied.load(std::memory_order_relaxed);
+		out.constructions = s.constructions.load(std::memory_order_relaxed);
+		out.wasted_bytes = s.wasted_bytes.load(std::memory_order_relaxed);
+		for (std::size_t i = 0; i < out.fill_histogram.size(); ++i)
+		{
+			out.fill_histogram[i] = s.fill_histogram[i].load(std::memory_order_relaxed);
+		}
+		return out;
+	}
+
+	/** @brief Sets every counter back to zero. */
+	inline void reset_stats() noexcept
+	{
+		detail::stats_counters& s = detail::global_stats;
+		for (auto* counter : { &s.view_truncations, &s.range_truncations, &s.fill_truncations, &s.concat_truncations,
+			&s.truncated_chars, &s.near_limit_appends, &s.overflows, &s.bytes_copied, &s.constructions, &s.wasted_bytes })
+		{
+			counter->store(0, std::memory_order_relaxed);
+		}
+		for (auto& counter : s.fill_histogram)
+		{
+			counter.store(0, std::memory_order_relaxed);
+		}
+	}
+#endif
+
+	namespace detail
+	{
+		/*
+		 * Recording hooks. They compile to nothing unless HYBSTR_STATS is defined, and never run
+		 * during constant evaluation.
+		 */
+
+		/** @brief Records a runtime construction that kept @p kept of @p requested characters in @p capacity. */
+		constexpr void stats_construct([[maybe_unused]] construct_site site, [[maybe_unused]] std::size_t requested,
+			[[maybe_unused]] std::size_t kept, [[maybe_unused]] std::size_t capacity) noexcept
+		{
+#if HYBSTR_HAS_STATS
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				stats_construct_runtime(site, requested, kept, capacity);
+			}
+#endif
+		}
+
+		/** @brief Records @p n characters copied by operator+, append, resize or reserve. */
+		constexpr void stats_copied([[maybe_unused]] std::size_t n) noexcept
+		{
+#if HYBSTR_HAS_STATS
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				stats_add(global_stats.bytes_copied, n);
+			}
+#endif
+		}
+
+		/** @brief Records an append<TargetSize>(std::string_view) of @p n characters, counted when above 3/4 of @p limit. */
+		constexpr void stats_append([[maybe_unused]] std::size_t n, [[maybe_unused]] std::size_t limit) noexcept
+		{
+#if HYBSTR_HAS_STATS
+			if (!HYBSTR_IS_CONSTANT_EVALUATED && 4 * n > 3 * limit)
+			{
+				stats_add(global_stats.near_limit_appends, 1);
+			}
+#endif
+		}
+
+		/** @brief Records an in-place append that did not fit. */
+		constexpr void stats_overflow() noexcept
+		{
+#if HYBSTR_HAS_STATS
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				stats_add(global_stats.overflows, 1);
+			}
+#endif
+		}
+	} // namespace detail
+
+	// ======================================================================
+	//                           Policies
+	// ======================================================================
+
+	/**
+	 * @brief Storage policy: characters always live in the fixed buffer.
+	 *
+	 * @details
+	 * Runtime inputs longer than 'BufferCapacity' are truncated by the constructors and
+	 * assert in 'append(std::string_view)'. This is the default.
+	 */
+	struct inline_storage {};
+
+	/**
+	 * @brief Storage policy: at runtime, contents longer than 'BufferCapacity' spill to the heap.
+	 *
+	 * @details
+	 * Works like a small string optimization: the fixed buffer holds the common case and
+	 * longer runtime data is moved to a heap allocation sized for it.
+	 * Constant evaluation keeps the fixed-buffer behavior of inline_storage.
+	 * Heap allocation failure terminates, since string_impl operations are 'noexcept'.
+	 * Requires C++20 to be usable in constant expressions (constexpr destructor).
+	 */
+	struct spill_storage {};
+
+	/**
+	 * @brief Storage policy: fixed buffer with no separate size field.
+	 *
+	 * @details
+	 * The last byte of the buffer holds the remaining capacity ('BufferCapacity - size()'),
+	 * which is 0, and therefore the null terminator, exactly when the string is full.
+	 * A 'string_impl<N>' with this storage is 'N + 1' bytes. Capacities above 255 (for example
+	 * a long concatenation) use the inline_storage layout. Behaves like inline_storage otherwise.
+	 */
+	struct packed_storage {};
+
+	/**
+	 * @brief Storage policy: fixed buffer laid out for fast ordering, "German string" style.
+	 *
+	 * @details
+	 * The size comes first, followed by an 8-byte aligned buffer of at least 8 characters whose first
+	 * 8 bytes are always initialized. Comparisons between two such strings load that 8-byte prefix
+	 * as one big-endian integer, masked to the size, and most of them finish on it. The prefix is
+	 * read from the characters themselves rather than cached, so writes through 'data()' or
+	 * 'operator[]' never leave it stale. Behaves like inline_storage otherwise.
+	 */
+	struct prefixed_storage {};
+
+	/**
+	 * @brief Overflow policy: in-place operations assert when the fixed buffer is full.
+	 * With 'NDEBUG' the input is truncated. This is the default.
+	 */
+	struct assert_overflow {};
+
+	/**
+	 * @brief Overflow policy: in-place operations silently keep what fits.
+	 */
+	struct truncate_overflow {};
+
+	/**
+	 * @brief Overflow policy: in-place operations throw 'std::length_error' when the fixed buffer is full.
+	 * The strong guarantee holds: nothing is written when throwing.
+	 */
+	struct throw_overflow {};
+
+	/**
+	 * @brief Capacity policy: derived capacities are used as computed. This is the default.
+	 */
+	struct exact_capacity
+	{
+		[[nodiscard]] static constexpr auto round(std::size_t n) noexcept -> std::size_t
+		{
+			return n;
+		}
+	};
+
+	/**
+	 * @brief Capacity policy: derived capacities are rounded up so that the buffer, terminator included,
+	 * holds a power of two characters.
+	 */
+	struct pow2_capacity
+	{
+		[[nodiscard]] static constexpr auto round(std::size_t n) noexcept -> std::size_t
+		{
+			return detail::bit_ceil(n + 1) - 1;
+		}
+	};
+
+	/**
+	 * @brief Capacity policy: derived capacities are rounded up so that the buffer, terminator included,
+	 * is a multiple of @p Line characters.
+	 */
+	template<std::size_t Line = 64>
+	struct cache_line_capacity
+	{
+		static_assert(Line > 0, "cache line size must not be zero");
+
+		[[nodiscard]] static constexpr auto round(std::size_t n) noexcept -> std::size_t
+		{
+			return (n + Line) / Line * Line - 1;
+		}
+	};
+
+	/**
+	 * @brief Capacity policy: applies @p Inner, then limits derived capacities to @p Max.
+	 * Results that do not fit are truncated, like runtime inputs passed to the constructors.
+	 */
+	template<std::size_t Max, typename Inner = exact_capacity>
+	struct clamp_capacity
+	{
+		[[nodiscard]] static constexpr auto round(std::size_t n) noexcept -> std::size_t
+		{
+			return std::min(Inner::round(n), Max);
+		}
+	};
+
+	/**
+	 * @brief Default policy bundle used by string_impl and the factory functions.
+	 *
+	 * @details
+	 * A policy is a type with the following members:
+	 * - 'storage': inline_storage, spill_storage, packed_storage or prefixed_storage.
+	 * - 'overflow': assert_overflow, truncate_overflow or throw_overflow. Used by the in-place
+	 *   operations ('append_inplace', 'operator+=', 'assign', ...) when the result does not fit.
+	 *   Never triggers at runtime with spill_storage.
+	 * - 'capacity': exact_capacity, pow2_capacity, cache_line_capacity or clamp_capacity. Applied to every
+	 *   capacity the library derives (appends, concatenation, factories, format), so that fewer distinct
+	 *   string_impl types are instantiated. Explicit capacities ('string_impl<N>', 'resize<N>', 'reserve<N>',
+	 *   'fit_string') are kept as given.
+	 *
+	 * Derive from default_policy (or use the with_* helpers) to change a single member.
+	 */
+	struct default_policy
+	{
+		using storage = inline_storage;
+		using overflow = assert_overflow;
+		using capacity = exact_capacity;
+	};
+
+	/**
+	 * @brief Replaces the storage policy of @p Base.
+	 */
+	template<typename Storage, typename Base = default_policy>
+	struct with_storage : Base
+	{
+		using storage = Storage;
+	};
+
+	/**
+	 * @brief Replaces the overflow policy of @p Base.
+	 */
+	template<typename Overflow, typename Base = default_policy>
+	struct with_overflow : Base
+	{
+		using overflow = Overflow;
+	};
+
+	/**
+	 * @brief Replaces the capacity policy of @p Base.
+	 */
+	template<typename Capacity, typename Base = default_policy>
+	struct with_capacity : Base
+	{
+		using capacity = Capacity;
+	};
+
+	/// @brief Policy that spills long runtime contents to the heap.
+	using spill_policy = with_storage<spill_storage>;
+
+	/// @brief Policy that stores the size in the last byte of the buffer.
+	using packed_policy = with_storage<packed_storage>;
+
+	/// @brief Policy that lays the buffer out for prefix comparisons.
+	using prefixed_policy = with_storage<prefixed_storage>;
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	#define HYBSTR_CONSTEXPR_DESTRUCTOR constexpr
+#else
+	#define HYBSTR_CONSTEXPR_DESTRUCTOR
+#endif
+
+// In C++20 the unused part of the buffer is left uninitialized at runtime (constant evaluation
+// still zeroes it, so NTTP values stay deterministic) and large buffers are copied up to the
+// terminator only. Define HYBSTR_ZERO_INIT to always zero and copy the whole buffer.
+#if HYBSTR_CPP_20_OR_ABOVE && !defined(HYBSTR_ZERO_INIT)
+	#define HYBSTR_UNINITIALIZED_BUFFER 1
+	#define HYBSTR_BUFFER_INIT
+#else
+	#define HYBSTR_UNINITIALIZED_BUFFER 0
+	#define HYBSTR_BUFFER_INIT {}
+#endif
+
+	namespace detail
+	{
+		/**
+		 * @brief Buffer and size of a string_impl, selected by the storage policy.
+		 *
+		 * @details
+		 * Every storage provides '_buffer()' (the active character buffer),
+		 * '_allocate(n)' (discards the contents and returns a buffer with room for @p n characters
+		 * plus the terminator) and '_reserve(n)' (same, but keeps the current contents).
+		 * Callers never request more than 'Capacity' characters from the storages that do not spill.
+		 * The size is read with '_length()' and written with '_set_length(n)', which leaves the
+		 * terminator to the caller.
+		 */
+		template<std::size_t Capacity, typename Storage>
+		struct string_storage;
+
+		/**
+		 * @brief Largest buffer capacity copied whole.
+		 * Up to a cache line, a fixed-size copy is cheaper than a length-dependent one.
+		 */
+		inline constexpr std::size_t trivial_copy_capacity = 64;
+
+		/**
+		 * @brief Copies the first @p n bytes of @p src to @p dst at runtime, and all of them in constant evaluation.
+		 */
+		template<std::size_t Size>
+		constexpr void copy_live(std::array<char, Size>& dst, const std::array<char, Size>& src, std::size_t n) noexcept
+		{
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				dst = src;
+			}
+			else
+			{
+				copy_chars(dst.data(), src.data(), n);
+			}
+		}
+
+		/** @brief Smallest unsigned type that can hold sizes up to @p Capacity. */
+		template<std::size_t Capacity>
+		using size_field_t =
+			std::conditional_t<Capacity <= UINT8_MAX, std::uint8_t,
+			std::conditional_t<Capacity <= UINT16_MAX, std::uint16_t,
+			std::conditional_t<Capacity <= UINT32_MAX, std::uint32_t, std::size_t>>>;
+
+		template<std::size_t Capacity>
+		struct string_storage<Capacity, inline_storage>
+		{
+			static constexpr bool spills = false;
+
+#if HYBSTR_UNINITIALIZED_BUFFER
+			constexpr string_storage() noexcept
+			{
+				if (HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					_data = {};
+				}
+			}
+			constexpr string_storage(const string_storage&) noexcept requires (Capacity <= trivial_copy_capacity) = default;
+			constexpr string_storage(const string_storage& other) noexcept
+				: _size(other._size)
+			{
+				copy_live(_data, other._data, _size + 1);
+			}
+			constexpr auto operator=(const string_storage&) noexcept -> string_storage& requires (Capacity <= trivial_copy_capacity) = default;
+			constexpr auto operator=(const string_storage& other) noexcept -> string_storage&
+			{
+				if (this != &other)
+				{
+					_size = other._size;
+					copy_live(_data, other._data, _size + 1);
+				}
+				return *this;
+			}
+#endif
+
+			[[nodiscard]] constexpr auto _buffer() noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _buffer() const noexcept -> const char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _allocate(std::size_t) noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _reserve(std::size_t) noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _length() const noexcept -> std::size_t
+			{
+				return _size;
+			}
+			constexpr void _set_length(std::size_t n) noexcept
+			{
+				_size = static_cast<size_field_t<Capacity>>(n);
+			}
+
+			std::array<char, Capacity + 1> _data HYBSTR_BUFFER_INIT; ///< Internal fixed buffer (+1 for null terminator).
+			size_field_t<Capacity> _size{}; ///< Number of characters currently stored.
+		};
+
+		/** @brief packed_storage layout: the last buffer byte holds the remaining capacity. */
+		template<std::size_t Capacity>
+		struct packed_buffer
+		{
+			static_assert(Capacity <= UINT8_MAX, "packed_buffer holds at most 255 characters");
+
+			static constexpr bool spills = false;
+
+			constexpr packed_buffer() noexcept
+			{
+#if HYBSTR_UNINITIALIZED_BUFFER
+				if (HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					_data = {};
+				}
+#endif
+				_data[Capacity] = static_cast<char>(Capacity);
+			}
+#if HYBSTR_UNINITIALIZED_BUFFER
+			constexpr packed_buffer(const packed_buffer&) noexcept requires (Capacity <= trivial_copy_capacity) = default;
+			constexpr packed_buffer(const packed_buffer& other) noexcept
+			{
+				copy_live(_data, other._data, other._length() + 1);
+				_data[Capacity] = other._data[Capacity];
+			}
+			constexpr auto operator=(const packed_buffer&) noexcept -> packed_buffer& requires (Capacity <= trivial_copy_capacity) = default;
+			constexpr auto operator=(const packed_buffer& other) noexcept -> packed_buffer&
+			{
+				if (this != &other)
+				{
+					copy_live(_data, other._data, other._length() + 1);
+					_data[Capacity] = other._data[Capacity];
+				}
+				return *this;
+			}
+#endif
+
+			[[nodiscard]] constexpr auto _buffer() noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _buffer() const noexcept -> const char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _allocate(std::size_t) noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _reserve(std::size_t) noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _length() const noexcept -> std::size_t
+			{
+				return Capacity - static_cast<unsigned char>(_data[Capacity]);
+			}
+			constexpr void _set_length(std::size_t n) noexcept
+			{
+				_data[Capacity] = static_cast<char>(Capacity - n);
+			}
+
+			std::array<char, Capacity + 1> _data HYBSTR_BUFFER_INIT; ///< Characters, then the remaining capacity (0 when full).
+		};
+
+		template<std::size_t Capacity>
+		struct string_storage<Capacity, packed_storage>
+			: std::conditional_t<(Capacity <= UINT8_MAX), packed_buffer<Capacity>, string_storage<Capacity, inline_storage>>
+		{
+		};
+
+		/** @brief prefixed_storage layout: the size, then a buffer whose first 8 bytes are always initialized. */
+		template<std::size_t Capacity>
+		struct string_storage<Capacity, prefixed_storage>
+		{
+			static constexpr bool spills = false;
+
+			/// @brief Characters in the buffer: room for the terminator, and never less than the prefix.
+			static constexpr std::size_t buffer_size = std::max<std::size_t>(Capacity + 1, 8);
+
+#if HYBSTR_UNINITIALIZED_BUFFER
+			constexpr string_storage() noexcept
+			{
+				if (HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					_data = {};
+				}
+				else
+				{
+					std::memset(_data.data(), 0, 8);
+				}
+			}
+			constexpr string_storage(const string_storage&) noexcept requires (Capacity <= trivial_copy_capacity) = default;
+			constexpr string_storage(const string_storage& other) noexcept
+				: _size(other._size)
+			{
+				copy_live(_data, other._data, std::max<std::size_t>(_size + 1, 8));
+			}
+			constexpr auto operator=(const string_storage&) noexcept -> string_storage& requires (Capacity <= trivial_copy_capacity) = default;
+			constexpr auto operator=(const string_storage& other) noexcept -> string_storage&
+			{
+				if (this != &other)
+				{
+					_size = other._size;
+					copy_live(_data, other._data, std::max<std::size_t>(_size + 1, 8));
+				}
+				return *this;
+			}
+#endif
+
+			[[nodiscard]] constexpr auto _buffer() noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _buffer() const noexcept -> const char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _allocate(std::size_t) noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _reserve(std::size_t) noexcept -> char*
+			{
+				return _data.data();
+			}
+			[[nodiscard]] constexpr auto _length() const noexcept -> std::size_t
+			{
+				return _size;
+			}
+			constexpr void _set_length(std::size_t n) noexcept
+			{
+				_size = static_cast<size_field_t<Capacity>>(n);
+			}
+
+			/** @brief Same value as 'prefix_key(_buffer(), _length(), 0)', from a single load. */
+			[[nodiscard]] constexpr auto _prefix() const noexcept -> std::uint64_t
+			{
+				const std::uint64_t word = load_be64(_data.data());
+				return _size >= 8 ? word : word & ~(~std::uint64_t{0} >> (8 * _size));
+			}
+
+			size_field_t<Capacity> _size{}; ///< Number of characters currently stored.
+			alignas(8) std::array<char, buffer_size> _data HYBSTR_BUFFER_INIT; ///< Prefix, then the rest of the characters and the terminator.
+		};
+
+		template<std::size_t Capacity>
+		struct string_storage<Capacity, spill_storage>
+		{
+			static constexpr bool spills = true;
+
+#if HYBSTR_UNINITIALIZED_BUFFER
+			constexpr string_storage() noexcept
+			{
+				if (HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					_data = {};
+				}
+			}
+#else
+			constexpr string_storage() noexcept = default;
+#endif
+			constexpr string_storage(const string_storage& other) noexcept
+				: _size(other._size)
+			{
+				if (other._heap)
+				{
+					detail::copy_chars(_allocate(other._size), other._heap, other._size + 1);
+				}
+				else
+				{
+					copy_live(_data, other._data, _size + 1);
+				}
+			}
+			constexpr string_storage(string_storage&& other) noexcept
+				: _size(other._size), _heap(other._heap), _heap_capacity(other._heap_capacity)
+			{
+				copy_live(_data, other._data, _heap ? 0 : _size + 1);
+				other._heap = nullptr;
+				other._heap_capacity = 0;
+				other._size = 0;
+				other._data[0] = '\0';
+			}
+			constexpr auto operator=(const string_storage& other) noexcept -> string_storage&
+			{
+				if (this != &other)
+				{
+					*this = string_storage(other);
+				}
+				return *this;
+			}
+			constexpr auto operator=(string_storage&& other) noexcept -> string_storage&
+			{
+				if (this != &other)
+				{
+					_release();
+					copy_live(_data, other._data, other._heap ? 0 : other._size + 1);
+					_size = other._size;
+					_heap = other._heap;
+					_heap_capacity = other._heap_capacity;
+					other._heap = nullptr;
+					other._heap_capacity = 0;
+					other._size = 0;
+					other._data[0] = '\0';
+				}
+				return *this;
+			}
+			HYBSTR_CONSTEXPR_DESTRUCTOR ~string_storage()
+			{
+				_release();
+			}
+
+			[[nodiscard]] constexpr auto _buffer() noexcept -> char*
+			{
+				return _heap ? _heap : _data.data();
+			}
+			[[nodiscard]] constexpr auto _buffer() const noexcept -> const char*
+			{
+				return _heap ? _heap : _data.data();
+			}
+			[[nodiscard]] constexpr auto _allocate(std::size_t n) noexcept -> char*
+			{
+				if (n <= Capacity)
+				{
+					_release();
+					return _data.data();
+				}
+				if (_heap_capacity < n)
+				{
+					_release();
+					_heap = new char[n + 1];
+					_heap_capacity = n;
+				}
+				return _heap;
+			}
+			[[nodiscard]] constexpr auto _reserve(std::size_t n) noexcept -> char*
+			{
+				const std::size_t current = _heap ? _heap_capacity : Capacity;
+				if (n <= current)
+				{
+					return _buffer();
+				}
+
+				const std::size_t grown = std::max(n, current * 2);
+				char* heap = new char[grown + 1];
+				copy_chars(heap, _buffer(), _size + 1);
+				_release();
+				_heap = heap;
+				_heap_capacity = grown;
+				return _heap;
+			}
+			[[nodiscard]] constexpr auto _length() const noexcept -> std::size_t
+			{
+				return _size;
+			}
+			constexpr void _set_length(std::size_t n) noexcept
+			{
+				_size = n;
+			}
+			constexpr void _release() noexcept
+			{
+				if (_heap)
+				{
+					delete[] _heap;
+					_heap = nullptr;
+					_heap_capacity = 0;
+				}
+			}
+
+			std::array<char, Capacity + 1> _data HYBSTR_BUFFER_INIT; ///< Inline buffer (+1 for null terminator).
+			std::size_t _size{}; ///< Number of characters currently stored.
+			char* _heap = nullptr; ///< Heap buffer used once the contents outgrow the inline buffer.
+			std::size_t _heap_capacity = 0; ///< Characters available in '_heap' (excluding the null terminator).
+		};
+
+		/// @brief True if strings using @p Policy spill to the heap at runtime.
+		template<typename Policy>
+		inline constexpr bool policy_spills_v = string_storage<0, typename Policy::storage>::spills;
+
+		/// @brief True if strings using @p Policy have the prefixed_storage layout.
+		template<typename Policy>
+		inline constexpr bool policy_prefixed_v = std::is_same_v<typename Policy::storage, prefixed_storage>;
+
+		/**
+		 * @brief Decides how many characters an in-place operation may write when @p requested exceed @p available.
+		 */
+		template<typename Overflow>
+		struct overflow_handler;
+
+		template<>
+		struct overflow_handler<assert_overflow>
+		{
+			static constexpr bool nothrow = true;
+
+			static constexpr auto handle(std::size_t requested, std::size_t available) noexcept -> std::size_t
+			{
+				// "string_impl overflow; increase the buffer capacity"
+				assert(requested <= available);
+				return available;
+			}
+		};
+
+		template<>
+		struct overflow_handler<truncate_overflow>
+		{
+			static constexpr bool nothrow = true;
+
+			static constexpr auto handle(std::size_t, std::size_t available) noexcept -> std::size_t
+			{
+				return available;
+			}
+		};
+
+		template<>
+		struct overflow_handler<throw_overflow>
+		{
+			static constexpr bool nothrow = false;
+
+			static constexpr auto handle(std::size_t requested, std::size_t available) -> std::size_t
+			{
+				if (requested > available)
+				{
+					throw std::length_error("hybstr::string_impl overflow");
+				}
+				return requested;
+			}
+		};
+
+		/// @brief True if the in-place operations of strings using @p Policy never throw.
+		template<typename Policy>
+		inline constexpr bool overflow_nothrow_v = overflow_handler<typename Policy::overflow>::nothrow;
+
+		/// @brief Capacity derived for @p N characters under @p Policy.
+		template<typename Policy, std::size_t N>
+		inline constexpr std::size_t policy_capacity_v = Policy::capacity::round(N);
+	} // namespace detail
+
+	template<std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY,
+		typename Policy = default_policy>
+	[[nodiscard]] constexpr auto string();
+	template<std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
+		typename Policy = default_policy,
+		std::size_t N>
+	[[nodiscard]] constexpr auto string(const char(&str)[N]);
+	template<std::size_t ViewSize = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
+		std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY,
+		typename Policy = default_policy>
+	[[nodiscard]] constexpr auto string(std::string_view sv) noexcept;
+	template<std::size_t RangeSize = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
+		std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, 
+		typename Policy = default_policy,
+		typename _Iter>
+	[[nodiscard]] constexpr auto string(_Iter start, _Iter end) noexcept;
+
+	template<typename L, typename R>
+	class concat_expr;
+
+	namespace detail
+	{
+		template<typename T>
+		constexpr void write_concat_piece(const T& piece, char* out, std::size_t& len, std::size_t total, std::size_t room) noexcept;
+	} // namespace detail
+
+	/**
+	 * @brief Fixed-capacity string that will expand on demand.
+	 *
+	 * @tparam BufferCapacity Number of characters stored in the compile-time buffer (excluding the null terminator).
+	 * @tparam DynamicExpandCapacity Size of the dynamic buffer allocated for runtime operations.
+	 * @tparam Policy Policy bundle, see default_policy.
+	 *
+	 * @details
+	 * Combines a compile-time buffer for constexpr evaluation with a dynamic buffer
+	 * for runtime use.
+	 * 'BufferCapacity' defines how many characters are stored in the fixed buffer,
+	 * and 'DynamicExpandCapacity' specifies the size of the dynamic region used when
+	 * handling inputs such as 'std::string_view' or iterator ranges whose lengths
+	 * cannot be determined at compile time.
+	 * The dynamic buffer size can also be customized through template arguments.
+	 *
+	 * This class is not intended to be used directly.
+	 * Prefer using the factory functions:
+	 * @code
+	 * auto s11 = hybstr::string();               // empty string
+	 * auto s12 = hybstr::string<10>();           // empty string with custom dynamic expand capacity
+	 *
+	 * auto s21 = hybstr::string("abc");          // from string literal
+	 * auto s22 = hybstr::string<10>("abc");      // from literal with custom dynamic expand capacity
+	 *
+	 * constexpr std::string_view sv = "abc";     // non-constexpr string views also work
+	 * auto s31 = hybstr::string<3>(sv);          // from string_view (specify length, default to HYBSTR_DYNAMIC_EXPAND_CAPACITY)
+	 * auto s32 = hybstr::string<3, 10>(sv);      // from string_view with custom expand capacity
+	 *
+	 * std::string str = "Hello world";
+	 * auto s41 = hybstr::string<11>(str.begin(), str.end());        // from iterator range (specify length, default to HYBSTR_DYNAMIC_EXPAND_CAPACITY)
+	 * auto s42 = hybstr::string<11, 10>(str.begin(), str.end());    // from iterator range with custom expand capacity
+	 *
+	 * auto s51 = hybstr::spill_string<64>(str);  // spills to the heap at runtime if str is longer than 64
+	 * @endcode
+	 *
+	 * Example:
+	 * @code
+	 * constexpr auto s1 = std::string_view("Greetings");
+	 * 
+	 * // Constexpr
+	 * constexpr auto s2 = hybstr::string("Name");
+	 * constexpr hybstr::string_impl s3 = hybstr::string(s1) + ", " + s2;
+	 * static_assert(s3 == hybstr::string("Greetings, Name"));
+	 * 
+	 * // Run time
+	 * std::string s4;
+	 * std::cin >> s4;
+	 * hybstr::string_impl s5 = hybstr::string(s1) + ", " + s4;
+	 * assert(s5.view() == std::string(s1.begin(), s1.end()) + ", " + s4);
+	 * @endcode
+	 */
+	template <std::size_t BufferCapacity = 0, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, typename Policy = default_policy>
+	class string_impl : public detail::string_storage<BufferCapacity, typename Policy::storage>
+	{
+		template <std::size_t, std::size_t, typename>
+		friend class string_impl;
+
+		using storage_type = detail::string_storage<BufferCapacity, typename Policy::storage>;
+	public:
+		using value_type = char;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+		using size_type = std::size_t;
+		using view_type = std::string_view;
+		using pointer = char*;
+		using const_pointer = const char*;
+		using policy_type = Policy;
+		using iterator = pointer;
+		using const_iterator = const_pointer;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		/// @brief "Not found" position returned by the search operations.
+		static constexpr size_type npos = detail::npos;
+
+		/** @brief Default constructor. Initializes an empty string. */
+		constexpr string_impl() noexcept
+		{
+			this->_set_length(0);
+			this->_data[0] = '\0';
+		}
+
+		/**
+		 * @brief Constructs from a string literal.
+		 * @tparam N Number of characters including null terminator.
+		 * @param str Null-terminated C-style string.
+		 */
+		template <std::size_t N>
+		constexpr string_impl(const char(&str)[N]) noexcept
+		{
+			static_assert(N > 0 && N - 1 <= BufferCapacity, "string literal too long");
+			detail::copy_chars(this->_data.data(), str, N - 1);
+			_set_size(N - 1);
+		}
+
+		/**
+		 * @brief Fills the buffer with a repeated character.
+		 * @param n Number of characters to fill.
+		 * @param c Fill character.
+		 */
+		constexpr string_impl(const std::size_t& n, char c) noexcept
+		{
+			const std::size_t len = _fit(n);
+			detail::fill_chars(this->_allocate(len), c, len);
+			_set_size(len);
+			detail::stats_construct(detail::construct_site::fill, n, len, capacity());
+		}
+
+		/**
+		 * @brief Constructs from a std::string_view.
+		 * Copies up to BufferCapacity characters (all of them if the storage spills).
+		 */
+		constexpr string_impl(std::string_view sv) noexcept
+		{
+			const std::size_t len = _fit(sv.size());
+			detail::copy_chars(this->_allocate(len), sv.data(), len);
+			_set_size(len);
+			detail::stats_construct(detail::construct_site::view, sv.size(), len, capacity());
+		}
+
+		/**
+		 * @brief Constructs from an iterator range.
+		 * Copies until 'end' or until BufferCapacity is reached (the whole range if the storage spills).
+		 */
+		template<typename _Iter>
+		constexpr string_impl(_Iter start, _Iter end) noexcept
+		{
+			std::size_t i = 0;
+
+			while (i < BufferCapacity && start != end)
+			{
+				this->_data[i++] = *(start++);
+			}
+
+			if constexpr (storage_type::spills)
+			{
+				if (!HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					while (start != end)
+					{
+						this->_set_length(i);
+						char* out = this->_reserve(i + 1);
+						out[i++] = *(start++);
+					}
+				}
+			}
+
+			_set_size(i);
+			detail::stats_construct(detail::construct_site::range, i + (start != end), i, capacity());
+		}
+
+		/**
+		 * @brief Materializes a concatenation expression.
+		 * Copies up to BufferCapacity characters (all of them if the storage spills).
+		 */
+		template<typename L, typename R>
+		constexpr string_impl(const concat_expr<L, R>& expr) noexcept
+		{
+			const std::size_t requested = expr.size();
+			const std::size_t total = _fit(requested);
+			char* out = this->_allocate(total);
+			std::size_t len = 0;
+			detail::write_concat_piece(expr, out, len, total, storage_type::spills ? 0 : BufferCapacity);
+			_set_size(len);
+			detail::stats_copied(len);
+			detail::stats_construct(detail::construct_site::concat, requested, len, capacity());
+		}
+
+		constexpr string_impl(const string_impl&) noexcept = default;
+		constexpr string_impl(string_impl&&) noexcept = default;
+		constexpr string_impl& operator=(const string_impl&) noexcept = default;
+		constexpr string_impl& operator=(string_impl&&) noexcept = default;
+
+		/**
+		 * @brief Exchanges the contents with @p other.
+		 * Copies only the characters in use (heap buffers are exchanged, not copied).
+		 */
+		constexpr void swap(string_impl& other) noexcept
+		{
+			string_impl tmp(std::move(other));
+			other = std::move(*this);
+			*this = std::move(tmp);
+		}
+		/** @brief Exchanges the contents of @p a and @p b. */
+		friend constexpr void swap(string_impl& a, string_impl& b) noexcept
+		{
+			a.swap(b);
+		}
+
+		/** @return Number of characters currently stored. */
+		[[nodiscard]] constexpr auto size() const noexcept -> size_type
+		{
+			return this->_length();
+		}
+		/** @return Maximum number of characters in the fixed buffer. */
+		[[nodiscard]] constexpr auto capacity() const noexcept -> size_type
+		{
+			return BufferCapacity;
+		}
+		/** @return True if the string is empty. */
+		[[nodiscard]] constexpr auto empty() const noexcept -> bool
+		{
+			return this->_length() == 0;
+		}
+		/** @return True if the contents currently live on the heap (spill_storage only). */
+		[[nodiscard]] constexpr auto spilled() const noexcept -> bool
+		{
+			return this->_buffer() != this->_data.data();
+		}
+
+		/** @return Mutable pointer to internal buffer. */
+		[[nodiscard]] constexpr auto data() noexcept -> pointer
+		{
+			return this->_buffer();
+		}
+		/** @return Const pointer to internal buffer. */
+		[[nodiscard]] constexpr auto data() const noexcept -> const_pointer
+		{
+			return this->_buffer();
+		}
+		/** @return Null-terminated C-string. */
+		[[nodiscard]] constexpr auto c_str() const noexcept -> const_pointer
+		{
+			return this->_buffer();
+		}
+		/** @return Read-only view of the string. */
+		[[nodiscard]] constexpr auto view() const noexcept -> view_type
+		{
+			return std::string_view(this->_buffer(), this->_length());
+		}
+		/** @return A new std::string copy of the contents (runtime). */
+		[[nodiscard]] auto str() const -> std::string
+		{
+			return std::string(begin(), end());
+		}
+
+
+		/** @brief Accesses a character by index (mutable). */
+		[[nodiscard]] constexpr auto operator[](size_type i) noexcept -> reference
+		{
+			return this->_buffer()[i];
+		}
+		/** @brief Accesses a character by index (const). */
+		[[nodiscard]] constexpr auto operator[](size_type i) const noexcept -> const_reference
+		{
+			return this->_buffer()[i];
+		}
+
+		[[nodiscard]] constexpr auto begin() noexcept -> iterator
+		{
+			return this->_buffer();
+		}
+		[[nodiscard]] constexpr auto begin() const noexcept -> const_iterator
+		{
+			return this->_buffer();
+		}
+		[[nodiscard]] constexpr auto cbegin() const noexcept -> const_iterator
+		{
+			return this->_buffer();
+		}
+		[[nodiscard]] constexpr auto end() noexcept -> iterator
+		{
+			return this->_buffer() + this->_length();
+		}
+		[[nodiscard]] constexpr auto end() const noexcept -> const_iterator
+		{
+			return this->_buffer() + this->_length();
+		}
+		[[nodiscard]] constexpr auto cend() const noexcept -> const_iterator
+		{
+			return this->_buffer() + this->_length();
+		}
+		[[nodiscard]] constexpr auto rbegin() noexcept -> reverse_iterator
+		{
+			return reverse_iterator(end());
+		}
+		[[nodiscard]] constexpr auto rbegin() const noexcept -> const_reverse_iterator
+		{
+			return const_reverse_iterator(end());
+		}
+		[[nodiscard]] constexpr auto crbegin() const noexcept -> const_reverse_iterator
+		{
+			return const_reverse_iterator(end());
+		}
+		[[nodiscard]] constexpr auto rend() noexcept -> reverse_iterator
+		{
+			return reverse_iterator(begin());
+		}
+		[[nodiscard]] constexpr auto rend() const noexcept -> const_reverse_iterator
+		{
+			return const_reverse_iterator(begin());
+		}
+		[[nodiscard]] constexpr auto crend() const noexcept -> const_reverse_iterator
+		{
+			return const_reverse_iterator(begin());
+		}
+
+		/**
+		 * @brief Replaces a character at compile time.
+		 * @tparam N Index to replace (must be less than BufferCapacity).
+		 * @param c New character value.
+		 * @return A new string_impl with the modified character.
+		 */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto set(char c) const noexcept
+		{
+			static_assert(N >= 0 && N < BufferCapacity, "index out of bound");
+			string_impl<BufferCapacity, DynamicExpandCapacity, Policy> result{ *this };
+			result.data()[N] = c;
+			result.data()[result._length()] = '\0';
+
+			return result;
+		}
+
+		/**
+		 * @brief Appends a C-style string literal.
+		 * @tparam N Number of characters including null terminator.
+		 * @return A new string_impl containing the concatenated result.
+		 */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto append(const char(&str)[N]) const noexcept
+		{
+			string_impl<detail::policy_capacity_v<Policy, BufferCapacity + N - 1>, DynamicExpandCapacity, Policy> result{};
+			result._assign_pair(this->_buffer(), this->_length(), str, N - 1);
+			return result;
+		}
+
+		/**
+		 * @brief Appends another hybrid string.
+		 * @tparam TargetSize Buffer expansion size for the result.
+		 * @tparam N BufferCapacity of the other string.
+		 * @tparam ExpandCapacity Dynamic capacity of the other string.
+		 * @tparam OtherPolicy Policy of the other string.
+		 * @return A new string_impl combining both contents.
+		 */
+		template<std::size_t TargetSize = DynamicExpandCapacity, std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto append(const string_impl<N, ExpandCapacity, OtherPolicy>& other) const noexcept
+		{
+			string_impl<
+				detail::policy_capacity_v<Policy, BufferCapacity + TargetSize>,
+				std::max(DynamicExpandCapacity, ExpandCapacity),
+				Policy
+			> result{};
+			result._assign_pair(this->_buffer(), this->_length(), other.data(), other.size());
+			return result;
+		}
+		/**
+		 * @brief Appends a std::string_view.
+		 * @tparam TargetSize Buffer expansion size for the result.
+		 */
+		template<std::size_t TargetSize = DynamicExpandCapacity>
+		[[nodiscard]] constexpr auto append(std::string_view sv) const noexcept
+		{
+			// "string_impl overflow; increase the dynamic buffer size"
+			assert((detail::policy_spills_v<Policy> && !HYBSTR_IS_CONSTANT_EVALUATED) || sv.size() <= TargetSize);
+			detail::stats_append(sv.size(), TargetSize);
+
+			string_impl<detail::policy_capacity_v<Policy, BufferCapacity + TargetSize>, DynamicExpandCapacity, Policy> result{};
+			result._assign_pair(this->_buffer(), this->_length(), sv.data(), sv.size());
+			return result;
+		}
+		/**
+		 * @brief Appends one or more repeated characters.
+		 * @tparam N Number of characters to add.
+		 */
+		template<std::size_t N = 1>
+		[[nodiscard]] constexpr auto append(char c) const noexcept
+		{
+			string_impl<detail::policy_capacity_v<Policy, BufferCapacity + N>, DynamicExpandCapacity, Policy> result{};
+			char* out = result._prepare(result._fit(this->_length() + N));
+			const std::size_t head = std::min(this->_length(), result._length());
+			detail::copy_chars(out, this->_buffer(), head);
+			detail::fill_chars(out + head, c, result._length() - head);
+			detail::stats_copied(result._length());
+			return result;
+		}
+
+		/** @brief Appends a single character. */
+		[[nodiscard]] constexpr auto push_back(char c) const noexcept
+		{
+			return append<1>(c);
+		}
+
+		/**
+		 * @brief Resizes the string to a new compile-time capacity.
+		 * @tparam N New capacity.
+		 * @param c Fill character if expanded.
+		 * @return A new string_impl with resized storage.
+		 */
+		template<std::size_t N>
+		[[nodiscard]] constexpr auto resize(char c = ' ') const noexcept
+		{
+			string_impl<N, DynamicExpandCapacity, Policy> result{};
+			char* out = result._prepare(N);
+
+			const std::size_t len = std::min(this->_length(), N);
+
+			detail::copy_chars(out, this->_buffer(), len);
+			detail::fill_chars(out + len, c, N - len);
+			detail::stats_copied(len);
+
+			return result;
+		}
+		/**
+		 * @brief Ensures compile-time capacity is at least N.
+		 * If current capacity is smaller, a new string_impl is created.
+		 */
+		template<std::size_t N>
+		[[nodiscard]] constexpr auto reserve() const noexcept
+		{
+			if constexpr (BufferCapacity < N)
+			{
+				string_impl<N, DynamicExpandCapacity, Policy> result{};
+				const std::size_t len = result._fit(this->_length());
+				detail::copy_chars(result._prepare(len), this->_buffer(), len);
+				detail::stats_copied(len);
+
+				return result;
+			}
+			else
+			{
+				return *this;
+			}
+		}
+
+		/** @brief Removes all characters. The capacity is unchanged. */
+		constexpr void clear() noexcept
+		{
+			_set_size(0);
+		}
+
+		/**
+		 * @brief Makes room for @p n characters in total, keeping the contents.
+		 * Grows the heap buffer with spill_storage at runtime; otherwise does nothing.
+		 */
+		constexpr void reserve_inplace(size_type n) noexcept
+		{
+			if constexpr (storage_type::spills)
+			{
+				if (!HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					(void)this->_reserve(n);
+				}
+			}
+			else
+			{
+				(void)n;
+			}
+		}
+
+		/**
+		 * @brief Appends a std::string_view in place.
+		 * Overflow is handled by the policy (the storage grows instead with spill_storage at runtime).
+		 * @return *this
+		 */
+		constexpr auto append_inplace(std::string_view sv) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			_append_raw(sv.data(), sv.size());
+			return *this;
+		}
+		/**
+		 * @brief Appends a C-style string literal in place.
+		 * @tparam N Number of characters including null terminator.
+		 * @return *this
+		 */
+		template <std::size_t N>
+		constexpr auto append_inplace(const char(&str)[N]) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			_append_raw(str, N - 1);
+			return *this;
+		}
+		/**
+		 * @brief Appends another hybrid string in place.
+		 * @return *this
+		 */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		constexpr auto append_inplace(const string_impl<N, ExpandCapacity, OtherPolicy>& other) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			_append_raw(other.data(), other.size());
+			return *this;
+		}
+		/**
+		 * @brief Appends a concatenation expression in place, without materializing it first.
+		 * @return *this
+		 */
+		template<typename L, typename R>
+		constexpr auto append_inplace(const concat_expr<L, R>& expr) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			const std::size_t len = _grow_by(expr.size());
+			char* out = this->_buffer() + this->_length();
+			std::size_t written = 0;
+			expr.for_each_piece([out, len, &written](std::string_view piece) constexpr noexcept
+			{
+				const std::size_t n = std::min(piece.size(), len - written);
+				detail::copy_chars(out + written, piece.data(), n);
+				written += n;
+			});
+			_set_size(this->_length() + len);
+			detail::stats_copied(len);
+			return *this;
+		}
+		/**
+		 * @brief Appends @p n copies of @p c in place.
+		 * @return *this
+		 */
+		constexpr auto append_inplace(size_type n, char c) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			const std::size_t len = _grow_by(n);
+			detail::fill_chars(this->_buffer() + this->_length(), c, len);
+			_set_size(this->_length() + len);
+			return *this;
+		}
+		/**
+		 * @brief Appends a single character in place.
+		 * @return *this
+		 */
+		constexpr auto push_back_inplace(char c) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			return append_inplace(1, c);
+		}
+
+		/** @brief Same as append_inplace(std::string_view). */
+		constexpr auto operator+=(std::string_view sv) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			return append_inplace(sv);
+		}
+		/** @brief Same as append_inplace(const char(&)[N]). */
+		template <std::size_t N>
+		constexpr auto operator+=(const char(&str)[N]) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			return append_inplace(str);
+		}
+		/** @brief Same as append_inplace(const string_impl&). */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		constexpr auto operator+=(const string_impl<N, ExpandCapacity, OtherPolicy>& other) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			return append_inplace(other);
+		}
+		/** @brief Same as append_inplace(const concat_expr&). */
+		template<typename L, typename R>
+		constexpr auto operator+=(const concat_expr<L, R>& expr) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			return append_inplace(expr);
+		}
+		/** @brief Same as push_back_inplace(char). */
+		constexpr auto operator+=(char c) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			return push_back_inplace(c);
+		}
+
+		/**
+		 * @brief Replaces the contents with a std::string_view (which may point into this string).
+		 * @return *this
+		 */
+		constexpr auto assign(std::string_view sv) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			this->_set_length(0);
+			_append_raw(sv.data(), sv.size());
+			return *this;
+		}
+		/**
+		 * @brief Replaces the contents with a C-style string literal.
+		 * @return *this
+		 */
+		template <std::size_t N>
+		constexpr auto assign(const char(&str)[N]) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			this->_set_length(0);
+			_append_raw(str, N - 1);
+			return *this;
+		}
+		/**
+		 * @brief Replaces the contents with another hybrid string.
+		 * @return *this
+		 */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		constexpr auto assign(const string_impl<N, ExpandCapacity, OtherPolicy>& other) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			this->_set_length(0);
+			_append_raw(other.data(), other.size());
+			return *this;
+		}
+		/**
+		 * @brief Replaces the contents with @p n copies of @p c.
+		 * @return *this
+		 */
+		constexpr auto assign(size_type n, char c) noexcept(detail::overflow_nothrow_v<Policy>) -> string_impl&
+		{
+			this->_set_length(0);
+			return append_inplace(n, c);
+		}
+
+		/** @return Position of the first occurrence of @p sv at or after @p pos, or npos. */
+		[[nodiscard]] constexpr auto find(std::string_view sv, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_chars(data(), size(), sv.data(), sv.size(), pos);
+		}
+		/** @return Position of the first occurrence of @p str at or after @p pos, or npos. The literal length is a compile-time constant. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto find(const char(&str)[N], size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_chars(data(), size(), str, N - 1, pos);
+		}
+		/** @return Position of the first occurrence of @p other at or after @p pos, or npos. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto find(const string_impl<N, ExpandCapacity, OtherPolicy>& other, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_chars(data(), size(), other.data(), other.size(), pos);
+		}
+		/** @return Position of the first occurrence of @p c at or after @p pos, or npos. */
+		[[nodiscard]] constexpr auto find(char c, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_char(data(), size(), c, pos);
+		}
+		/** @return Position of the last occurrence of @p sv starting at or before @p pos, or npos. */
+		[[nodiscard]] constexpr auto rfind(std::string_view sv, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_chars(data(), size(), sv.data(), sv.size(), pos);
+		}
+		/** @return Position of the last occurrence of @p str starting at or before @p pos, or npos. The literal length is a compile-time constant. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto rfind(const char(&str)[N], size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_chars(data(), size(), str, N - 1, pos);
+		}
+		/** @return Position of the last occurrence of @p other starting at or before @p pos, or npos. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto rfind(const string_impl<N, ExpandCapacity, OtherPolicy>& other, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_chars(data(), size(), other.data(), other.size(), pos);
+		}
+		/** @return Position of the last occurrence of @p c starting at or before @p pos, or npos. */
+		[[nodiscard]] constexpr auto rfind(char c, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_chars(data(), size(), &c, 1, pos);
+		}
+		/** @return Position of the first character at or after @p pos that is in @p sv, or npos. */
+		[[nodiscard]] constexpr auto find_first_of(std::string_view sv, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<true>(data(), size(), sv.data(), sv.size(), pos);
+		}
+		/** @return Position of the first character at or after @p pos that is in @p str, or npos. The literal length is a compile-time constant. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto find_first_of(const char(&str)[N], size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<true>(data(), size(), str, N - 1, pos);
+		}
+		/** @return Position of the first character at or after @p pos that is in @p other, or npos. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto find_first_of(const string_impl<N, ExpandCapacity, OtherPolicy>& other, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<true>(data(), size(), other.data(), other.size(), pos);
+		}
+		/** @return Position of the first character at or after @p pos that is in @p c, or npos. */
+		[[nodiscard]] constexpr auto find_first_of(char c, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<true>(data(), size(), &c, 1, pos);
+		}
+		/** @return Position of the last character at or before @p pos that is in @p sv, or npos. */
+		[[nodiscard]] constexpr auto find_last_of(std::string_view sv, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<true>(data(), size(), sv.data(), sv.size(), pos);
+		}
+		/** @return Position of the last character at or before @p pos that is in @p str, or npos. The literal length is a compile-time constant. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto find_last_of(const char(&str)[N], size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<true>(data(), size(), str, N - 1, pos);
+		}
+		/** @return Position of the last character at or before @p pos that is in @p other, or npos. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto find_last_of(const string_impl<N, ExpandCapacity, OtherPolicy>& other, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<true>(data(), size(), other.data(), other.size(), pos);
+		}
+		/** @return Position of the last character at or before @p pos that is in @p c, or npos. */
+		[[nodiscard]] constexpr auto find_last_of(char c, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<true>(data(), size(), &c, 1, pos);
+		}
+		/** @return Position of the first character at or after @p pos that is not in @p sv, or npos. */
+		[[nodiscard]] constexpr auto find_first_not_of(std::string_view sv, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<false>(data(), size(), sv.data(), sv.size(), pos);
+		}
+		/** @return Position of the first character at or after @p pos that is not in @p str, or npos. The literal length is a compile-time constant. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto find_first_not_of(const char(&str)[N], size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<false>(data(), size(), str, N - 1, pos);
+		}
+		/** @return Position of the first character at or after @p pos that is not in @p other, or npos. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto find_first_not_of(const string_impl<N, ExpandCapacity, OtherPolicy>& other, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<false>(data(), size(), other.data(), other.size(), pos);
+		}
+		/** @return Position of the first character at or after @p pos that is not in @p c, or npos. */
+		[[nodiscard]] constexpr auto find_first_not_of(char c, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_of_chars<false>(data(), size(), &c, 1, pos);
+		}
+		/** @return Position of the last character at or before @p pos that is not in @p sv, or npos. */
+		[[nodiscard]] constexpr auto find_last_not_of(std::string_view sv, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<false>(data(), size(), sv.data(), sv.size(), pos);
+		}
+		/** @return Position of the last character at or before @p pos that is not in @p str, or npos. The literal length is a compile-time constant. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto find_last_not_of(const char(&str)[N], size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<false>(data(), size(), str, N - 1, pos);
+		}
+		/** @return Position of the last character at or before @p pos that is not in @p other, or npos. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto find_last_not_of(const string_impl<N, ExpandCapacity, OtherPolicy>& other, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<false>(data(), size(), other.data(), other.size(), pos);
+		}
+		/** @return Position of the last character at or before @p pos that is not in @p c, or npos. */
+		[[nodiscard]] constexpr auto find_last_not_of(char c, size_type pos = npos) const noexcept -> size_type
+		{
+			return detail::rfind_of_chars<false>(data(), size(), &c, 1, pos);
+		}
+		/** @return True if @p sv occurs in this string. */
+		[[nodiscard]] constexpr auto contains(std::string_view sv) const noexcept -> bool
+		{
+			return find(sv) != npos;
+		}
+		/** @return True if @p str occurs in this string. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto contains(const char(&str)[N]) const noexcept -> bool
+		{
+			return find(str) != npos;
+		}
+		/** @return True if @p other occurs in this string. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto contains(const string_impl<N, ExpandCapacity, OtherPolicy>& other) const noexcept -> bool
+		{
+			return find(other) != npos;
+		}
+		/** @return True if @p c occurs in this string. */
+		[[nodiscard]] constexpr auto contains(char c) const noexcept -> bool
+		{
+			return find(c) != npos;
+		}
+		/** @return True if this string begins with @p sv. */
+		[[nodiscard]] constexpr auto starts_with(std::string_view sv) const noexcept -> bool
+		{
+			return sv.size() <= size() && detail::equal_chars(data(), sv.data(), sv.size());
+		}
+		/** @return True if this string begins with @p str. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto starts_with(const char(&str)[N]) const noexcept -> bool
+		{
+			return N - 1 <= size() && detail::equal_chars(data(), str, N - 1);
+		}
+		/** @return True if this string begins with @p other. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto starts_with(const string_impl<N, ExpandCapacity, OtherPolicy>& other) const noexcept -> bool
+		{
+			return other.size() <= size() && detail::equal_chars(data(), other.data(), other.size());
+		}
+		/** @return True if this string begins with @p c. */
+		[[nodiscard]] constexpr auto starts_with(char c) const noexcept -> bool
+		{
+			return !empty() && data()[0] == c;
+		}
+		/** @return True if this string ends with @p sv. */
+		[[nodiscard]] constexpr auto ends_with(std::string_view sv) const noexcept -> bool
+		{
+			return sv.size() <= size() && detail::equal_chars(data() + size() - sv.size(), sv.data(), sv.size());
+		}
+		/** @return True if this string ends with @p str. */
+		template <std::size_t N>
+		[[nodiscard]] constexpr auto ends_with(const char(&str)[N]) const noexcept -> bool
+		{
+			return N - 1 <= size() && detail::equal_chars(data() + size() - (N - 1), str, N - 1);
+		}
+		/** @return True if this string ends with @p other. */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		[[nodiscard]] constexpr auto ends_with(const string_impl<N, ExpandCapacity, OtherPolicy>& other) const noexcept -> bool
+		{
+			return other.size() <= size() && detail::equal_chars(data() + size() - other.size(), other.data(), other.size());
+		}
+		/** @return True if this string ends with @p c. */
+		[[nodiscard]] constexpr auto ends_with(char c) const noexcept -> bool
+		{
+			return !empty() && data()[size() - 1] == c;
+		}
+
+		/** @return Copy with the ASCII letters converted to upper case. Other bytes are unchanged. */
+		[[nodiscard]] constexpr auto to_upper() const noexcept -> string_impl
+		{
+			string_impl result{};
+			detail::flip_case_chars<'a', 'z'>(result._prepare(size()), data(), size());
+			return result;
+		}
+		/** @return Copy with the ASCII letters converted to lower case. Other bytes are unchanged. */
+		[[nodiscard]] constexpr auto to_lower() const noexcept -> string_impl
+		{
+			string_impl result{};
+			detail::flip_case_chars<'A', 'Z'>(result._prepare(size()), data(), size());
+			return result;
+		}
+		/**
+		 * @brief Converts the ASCII letters to upper case in place.
+		 * @return *this
+		 */
+		constexpr auto to_upper_inplace() noexcept -> string_impl&
+		{
+			detail::flip_case_chars<'a', 'z'>(this->_buffer(), this->_buffer(), size());
+			return *this;
+		}
+		/**
+		 * @brief Converts the ASCII letters to lower case in place.
+		 * @return *this
+		 */
+		constexpr auto to_lower_inplace() noexcept -> string_impl&
+		{
+			detail::flip_case_chars<'A', 'Z'>(this->_buffer(), this->_buffer(), size());
+			return *this;
+		}
+
+		/** @return Copy without leading and trailing ASCII whitespace. */
+		[[nodiscard]] constexpr auto trim() const noexcept -> string_impl
+		{
+			return string_impl(detail::trim_view<true, true>(view()));
+		}
+		/** @return Copy without leading ASCII whitespace. */
+		[[nodiscard]] constexpr auto trim_left() const noexcept -> string_impl
+		{
+			return string_impl(detail::trim_view<true, false>(view()));
+		}
+		/** @return Copy without trailing ASCII whitespace. */
+		[[nodiscard]] constexpr auto trim_right() const noexcept -> string_impl
+		{
+			return string_impl(detail::trim_view<false, true>(view()));
+		}
+
+		/** @return Copy with every @p from replaced by @p to. */
+		[[nodiscard]] constexpr auto replace(char from, char to) const noexcept -> string_impl
+		{
+			string_impl result{};
+			detail::replace_char(result._prepare(size()), data(), size(), from, to);
+			return result;
+		}
+		/**
+		 * @brief Replaces every @p from with @p to in place.
+		 * @return *this
+		 */
+		constexpr auto replace_inplace(char from, char to) noexcept -> string_impl&
+		{
+			detail::replace_char(this->_buffer(), this->_buffer(), size(), from, to);
+			return *this;
+		}
+		/**
+		 * @brief Replaces every non-overlapping occurrence of @p from with @p to, scanning left to right.
+		 *
+		 * @details
+		 * Both lengths are compile-time constants, so the result capacity is too: BufferCapacity when
+		 * the replacement is not longer, otherwise enough for a string made only of matches.
+		 */
+		template <std::size_t N, std::size_t M>
+		[[nodiscard]] constexpr auto replace_all(const char(&from)[N], const char(&to)[M]) const noexcept
+		{
+			static_assert(N > 1, "hybstr::replace_all: the pattern must not be empty");
+			constexpr std::size_t capacity = M <= N ? BufferCapacity : BufferCapacity + BufferCapacity / (N - 1) * (M - N);
+			string_impl<detail::policy_capacity_v<Policy, capacity>, DynamicExpandCapacity, Policy> result{};
+
+			std::size_t pos = 0;
+			for (std::size_t hit = find(from); hit != npos; hit = find(from, pos))
+			{
+				result.append_inplace(std::string_view(data() + pos, hit - pos));
+				result.append_inplace(std::string_view(to, M - 1));
+				pos = hit + (N - 1);
+			}
+			result.append_inplace(std::string_view(data() + pos, size() - pos));
+			return result;
+		}
+
+	private:
+		/**
+		 * @brief Number of characters kept when @p n are requested.
+		 * Clamped to BufferCapacity, except for spilling storage at runtime.
+		 */
+		[[nodiscard]] static constexpr auto _fit(std::size_t n) noexcept -> std::size_t
+		{
+			if constexpr (storage_type::spills)
+			{
+				if (!HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					return n;
+				}
+			}
+			return std::min(n, BufferCapacity);
+		}
+		/** @brief Sets the size and writes the null terminator. */
+		constexpr void _set_size(std::size_t n) noexcept
+		{
+			this->_set_length(n);
+			this->_buffer()[n] = '\0';
+		}
+		/**
+		 * @brief Makes room for @p n more characters.
+		 * @return Number of characters that may be appended, as decided by the overflow policy.
+		 */
+		constexpr auto _grow_by(std::size_t n) noexcept(detail::overflow_nothrow_v<Policy>) -> std::size_t
+		{
+			if constexpr (storage_type::spills)
+			{
+				if (!HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					(void)this->_reserve(this->_length() + n);
+					return n;
+				}
+			}
+
+			const std::size_t available = BufferCapacity - this->_length();
+			if (n > available)
+			{
+				detail::stats_overflow();
+				return detail::overflow_handler<typename Policy::overflow>::handle(n, available);
+			}
+			return n;
+		}
+		/**
+		 * @brief Appends @p n characters from @p in (which may point into this string).
+		 * @return Number of characters appended.
+		 */
+		constexpr auto _append_raw(const char* in, std::size_t n) noexcept(detail::overflow_nothrow_v<Policy>) -> std::size_t
+		{
+			if constexpr (storage_type::spills)
+			{
+				if (!HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					// Growing may move the buffer 'in' points into.
+					const char* old = this->_buffer();
+					const bool aliased = std::less_equal<>{}(old, in) && std::less<>{}(in, old + this->_length() + 1);
+					const std::size_t offset = aliased ? static_cast<std::size_t>(in - old) : 0;
+					(void)_grow_by(n);
+					if (aliased)
+					{
+						in = this->_buffer() + offset;
+					}
+
+					detail::move_chars(this->_buffer() + this->_length(), in, n);
+					_set_size(this->_length() + n);
+					detail::stats_copied(n);
+					return n;
+				}
+			}
+
+			const std::size_t len = _grow_by(n);
+			detail::move_chars(this->_buffer() + this->_length(), in, len);
+			_set_size(this->_length() + len);
+			detail::stats_copied(len);
+			return len;
+		}
+		/**
+		 * @brief Discards the contents, sets the size to @p n and returns the buffer to write the characters to.
+		 */
+		[[nodiscard]] constexpr auto _prepare(std::size_t n) noexcept -> char*
+		{
+			char* out = this->_allocate(n);
+			this->_set_length(n);
+			out[n] = '\0';
+			return out;
+		}
+		/**
+		 * @brief Replaces the contents with @p a followed by @p b, keeping what fits.
+		 * Neither input may point into this string.
+		 */
+		constexpr void _assign_pair(const char* a, std::size_t na, const char* b, std::size_t nb) noexcept
+		{
+			char* out = _prepare(_fit(na + nb));
+			const std::size_t head = std::min(na, this->_length());
+			detail::copy_chars(out, a, head);
+			detail::copy_chars(out + head, b, this->_length() - head);
+			detail::stats_copied(this->_length());
+		}
+	};
+
+	/// @brief string_impl whose runtime contents spill to the heap once they outgrow the fixed buffer.
+	template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY>
+	using spill_string = string_impl<BufferCapacity, DynamicExpandCapacity, spill_policy>;
+
+	/// @brief string_impl that keeps its size in the last byte of the buffer (up to 255 characters).
+	template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY>
+	using packed_string = string_impl<BufferCapacity, DynamicExpandCapacity, packed_policy>;
+
+	/// @brief string_impl laid out for prefix comparisons, for large sorted or deduplicated key sets.
+	template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY>
+	using prefixed_string = string_impl<BufferCapacity, DynamicExpandCapacity, prefixed_policy>;
+
+	template<std::size_t N>
+	string_impl(const char(&)[N]) -> string_impl<N - 1>;
+
+	// ======================================================================
+	//                        Concatenation Expressions
+	// ======================================================================
+
+	namespace detail
+	{
+		template<typename T>
+		using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+		/// @brief Detects hybstr::concat_expr.
+		template<typename T>
+		struct is_concat_expr : std::false_type {};
+		template<typename L, typename R>
+		struct is_concat_expr<concat_expr<L, R>> : std::true_type {};
+
+		/// @brief Detects the types that can start a concatenation expression (string_impl or concat_expr).
+		template<typename T>
+		struct is_concat_root : is_concat_expr<T> {};
+		template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy>
+		struct is_concat_root<string_impl<BufferCapacity, DynamicExpandCapacity, Policy>> : std::true_type {};
+
+		/**
+		 * @brief Maps an operand of 'operator+' to the type stored inside a concat_expr.
+		 *
+		 * @details
+		 * Lvalue strings are referenced, rvalues are moved in, string literals are copied
+		 * into a 'std::array' so the expression stays a structural type, and character pointers
+		 * are wrapped in a 'std::string_view'. Types without a mapping are not concatenable.
+		 */
+		template<typename T, typename U = remove_cvref_t<T>, typename = void>
+		struct concat_storage {};
+		template<typename T, std::size_t B, std::size_t D, typename P>
+		struct concat_storage<T, string_impl<B, D, P>>
+		{
+			using type = std::conditional_t<std::is_lvalue_reference_v<T>, const string_impl<B, D, P>&, string_impl<B, D, P>>;
+		};
+		template<typename T, typename L, typename R>
+		struct concat_storage<T, concat_expr<L, R>>
+		{
+			using type = concat_expr<L, R>;
+		};
+		template<typename T, std::size_t N>
+		struct concat_storage<T, char[N]>
+		{
+			using type = std::array<char, N - 1>;
+		};
+		template<typename T>
+		struct concat_storage<T, char>
+		{
+			using type = char;
+		};
+		template<typename T>
+		struct concat_storage<T, std::string_view>
+		{
+			using type = std::string_view;
+		};
+		template<typename T, typename U>
+		struct concat_storage<T, U, std::enable_if_t<
+			std::is_class_v<U> && !std::is_same_v<U, std::string_view> && !is_concat_root<U>::value &&
+			std::is_convertible_v<const U&, std::string_view>>>
+		{
+			using type = std::conditional_t<std::is_lvalue_reference_v<T>, const U&, U>;
+		};
+		template<typename T, typename U>
+		struct concat_storage<T, U, std::enable_if_t<
+			std::is_pointer_v<U> && std::is_convertible_v<U, std::string_view>>>
+		{
+			using type = std::string_view;
+		};
+
+		/**
+		 * @brief Largest fixed buffer copied whole into a concatenation result.
+		 * A fixed-size copy of up to 256 bytes is a handful of vector moves; a length-dependent one is a loop or a call.
+		 */
+		inline constexpr std::size_t whole_concat_capacity = 256;
+
+		/// @brief Right operand of the single-operand expression returned by 'lazy'. Contributes nothing.
+		struct concat_empty {};
+
+		template<typename T>
+		using concat_storage_t = typename concat_storage<T>::type;
+
+		template<typename T, typename = void>
+		struct is_concat_operand : std::false_type {};
+		template<typename T>
+		struct is_concat_operand<T, std::void_t<concat_storage_t<T>>> : std::true_type {};
+
+		/// @brief Enables 'operator+' when both operands are concatenable and at least one is a hybstr string.
+		template<typename L, typename R>
+		using enable_concat_t = std::enable_if_t<
+			is_concat_operand<L>::value && is_concat_operand<R>::value &&
+			(is_concat_root<remove_cvref_t<L>>::value || is_concat_root<remove_cvref_t<R>>::value), int>;
+
+		/**
+		 * @brief Describes how a stored operand contributes to the result capacity and how to read it.
+		 *
+		 * @details
+		 * The primary template covers runtime sized pieces ('std::string_view' and classes convertible to it),
+		 * which contribute one 'DynamicExpandCapacity' each, mirroring 'string_impl::append(std::string_view)'.
+		 */
+		template<typename T>
+		struct concat_piece
+		{
+			static constexpr std::size_t capacity = 0; ///< Characters reserved at compile time.
+			static constexpr std::size_t dynamic = 1;  ///< Number of runtime sized pieces.
+			static constexpr std::size_t expand = 0;   ///< Dynamic expand capacity carried by the piece.
+			static constexpr std::size_t pieces = 1;   ///< Number of leaf operands.
+			static constexpr std::size_t whole = 0;    ///< Characters readable at 'view().data()' whatever the size, 0 if unknown.
+			using policy = void;                       ///< Policy carried by the piece (void if none).
+
+			[[nodiscard]] static constexpr auto view(const T& piece) noexcept -> std::string_view
+			{
+				return std::string_view(piece);
+			}
+		};
+		template<std::size_t B, std::size_t D, typename P>
+		struct concat_piece<string_impl<B, D, P>>
+		{
+			static constexpr std::size_t capacity = B;
+			static constexpr std::size_t dynamic = 0;
+			static constexpr std::size_t expand = D;
+			static constexpr std::size_t pieces = 1;
+			static constexpr std::size_t whole = !policy_spills_v<P> && B <= whole_concat_capacity ? B : 0;
+			using policy = P;
+
+			[[nodiscard]] static constexpr auto view(const string_impl<B, D, P>& piece) noexcept -> std::string_view
+			{
+				return piece.view();
+			}
+		};
+		template<std::size_t N>
+		struct concat_piece<std::array<char, N>>
+		{
+			static constexpr std::size_t capacity = N;
+			static constexpr std::size_t dynamic = 0;
+			static constexpr std::size_t expand = 0;
+			static constexpr std::size_t pieces = 1;
+			static constexpr std::size_t whole = N <= whole_concat_capacity ? N : 0;
+			using policy = void;
+
+			[[nodiscard]] static constexpr auto view(const std::array<char, N>& piece) noexcept -> std::string_view
+			{
+				return std::string_view(piece.data(), N);
+			}
+		};
+		template<>
+		struct concat_piece<char>
+		{
+			static constexpr std::size_t capacity = 1;
+			static constexpr std::size_t dynamic = 0;
+			static constexpr std::size_t expand = 0;
+			static constexpr std::size_t pieces = 1;
+			static constexpr std::size_t whole = 1;
+			using policy = void;
+
+			[[nodiscard]] static constexpr auto view(const char& piece) noexcept -> std::string_view
+			{
+				return std::string_view(&piece, 1);
+			}
+		};
+		template<>
+		struct concat_piece<concat_empty>
+		{
+			static constexpr std::size_t capacity = 0;
+			static constexpr std::size_t dynamic = 0;
+			static constexpr std::size_t expand = 0;
+			static constexpr std::size_t pieces = 0;
+			static constexpr std::size_t whole = 0;
+			using policy = void;
+		};
+		template<typename L, typename R>
+		struct concat_piece<concat_expr<L, R>>
+		{
+			static constexpr std::size_t capacity = concat_expr<L, R>::static_capacity;
+			static constexpr std::size_t dynamic = concat_expr<L, R>::dynamic_pieces;
+			static constexpr std::size_t expand = concat_expr<L, R>::dynamic_expand_capacity;
+			static constexpr std::size_t pieces = concat_expr<L, R>::piece_count;
+			using policy = typename concat_expr<L, R>::policy_type;
+		};
+
+		/// @brief Picks the policy of the leftmost string_impl operand.
+		template<typename P1, typename P2>
+		using concat_policy_t = std::conditional_t<std::is_void_v<P1>, P2, P1>;
+
+		/// @brief Converts an operand of 'operator+' into its stored representation.
+		template<typename T>
+		[[nodiscard]] constexpr auto make_concat_piece(T&& value) noexcept -> concat_storage_t<T>
+		{
+			using U = remove_cvref_t<T>;
+			if constexpr (std::is_array_v<U>)
+			{
+				concat_storage_t<T> piece{};
+				copy_chars(piece.data(), value, piece.size());
+				return piece;
+			}
+			else if constexpr (std::is_pointer_v<U>)
+			{
+				return std::string_view(value);
+			}
+			else
+			{
+				return std::forward<T>(value);
+			}
+		}
+
+		/// @brief Calls @p f with a 'std::string_view' of every leaf of @p piece, left to right.
+		template<typename T, typename F>
+		constexpr void for_each_concat_piece(const T& piece, F& f) noexcept
+		{
+			if constexpr (is_concat_expr<T>::value)
+			{
+				for_each_concat_piece(piece._lhs, f);
+				for_each_concat_piece(piece._rhs, f);
+			}
+			else if constexpr (!std::is_same_v<T, concat_empty>)
+			{
+				f(concat_piece<T>::view(piece));
+			}
+		}
+
+		/**
+		 * @brief Appends the leaves of @p piece to @p out, of which @p len characters are written, up to @p total.
+		 *
+		 * @details
+		 * @p out has room for @p room characters. At runtime, a leaf with a small fixed buffer ('concat_piece::whole')
+		 * is copied whole when that fits in @p room: a few fixed-size moves instead of a length-dependent copy.
+		 * The bytes past the leaf are overwritten by the next leaves or end up past the terminator.
+		 */
+// GCC does not see that a leaf holds at most its capacity, and warns that the copy could read past it.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Warray-bounds"
+	#pragma GCC diagnostic ignored "-Wstringop-overread"
+#endif
+		template<typename T>
+		constexpr void write_concat_piece(const T& piece, char* out, std::size_t& len, std::size_t total, std::size_t room) noexcept
+		{
+			if constexpr (is_concat_expr<T>::value)
+			{
+				write_concat_piece(piece._lhs, out, len, total, room);
+				write_concat_piece(piece._rhs, out, len, total, room);
+			}
+			else if constexpr (!std::is_same_v<T, concat_empty>)
+			{
+				const std::string_view sv = concat_piece<T>::view(piece);
+				constexpr std::size_t whole = concat_piece<T>::whole;
+				if constexpr (whole != 0)
+				{
+					if (!HYBSTR_IS_CONSTANT_EVALUATED && len + whole <= room && sv.size() <= total - len)
+					{
+						std::memcpy(out + len, sv.data(), whole);
+						len += sv.size();
+						return;
+					}
+				}
+				const std::size_t n = std::min(sv.size(), total - len);
+				if (HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					copy_chars(out + len, sv.data(), n);
+				}
+				else if (n != 0)
+				{
+					std::memcpy(out + len, sv.data(), n);
+				}
+				len += n;
+			}
+		}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+	#pragma GCC diagnostic pop
+#endif
+	} // namespace detail
+
+	/**
+	 * @brief Lazy concatenation of two operands, started with 'lazy'.
+	 *
+	 * @tparam L Stored left operand (a reference to an lvalue string_impl, or a value).
+	 * @tparam R Stored right operand.
+	 *
+	 * @details
+	 * 'operator+' with a concat_expr operand builds a tree of concat_expr nodes that only records its operands.
+	 * The characters are copied exactly once, into a string_impl whose capacity is the sum of all
+	 * operand capacities, when the expression is converted, compared or materialized.
+	 * Literals count 'N - 1' characters, chars count one, and each 'std::string_view' counts
+	 * 'DynamicExpandCapacity' (the largest one among the string_impl operands).
+	 *
+	 * Lifetime: like a 'std::string_view', the expression refers to its lvalue operands (string_impl,
+	 * 'std::string', ...) instead of copying them, so it must not outlive them. Rvalues, literals and
+	 * chars are stored in it. Convert the expression to a string_impl (or call materialize() or
+	 * str()) before any of its operands goes out of scope, and do not return one that refers to
+	 * parameters or locals:
+	 * @code
+	 * constexpr auto s1 = hybstr::string("Hello");
+	 * static_assert(hybstr::lazy(s1) + ", " + "World" == hybstr::string("Hello, World"));
+	 *
+	 * constexpr hybstr::string_impl s2 = hybstr::lazy(s1) + ", " + "World";    // single right-sized copy
+	 * auto s3 = (hybstr::lazy(s1) + '!').materialize().view();
+	 * @endcode
+	 */
+	template<typename L, typename R>
+	class concat_expr
+	{
+		using lhs_piece = detail::concat_piece<detail::remove_cvref_t<L>>;
+		using rhs_piece = detail::concat_piece<detail::remove_cvref_t<R>>;
+	public:
+		using size_type = std::size_t;
+
+		/** @brief Dynamic expand capacity of the result (largest among the string_impl operands). */
+		static constexpr size_type dynamic_expand_capacity = std::max(lhs_piece::expand, rhs_piece::expand);
+		/** @brief Number of runtime sized operands ('std::string_view' and friends). */
+		static constexpr size_type dynamic_pieces = lhs_piece::dynamic + rhs_piece::dynamic;
+		/** @brief Number of leaf operands, i.e. the number of views returned by 'segments()'. */
+		static constexpr size_type piece_count = lhs_piece::pieces + rhs_piece::pieces;
+		/** @brief Capacity contributed by the operands with a compile-time capacity. */
+		static constexpr size_type static_capacity = lhs_piece::capacity + rhs_piece::capacity;
+		/** @brief Capacity needed by the operands, before the capacity policy is applied. */
+		static constexpr size_type reserved_capacity = static_capacity + dynamic_pieces * dynamic_expand_capacity;
+
+		/** @brief Policy of the result (the policy of the leftmost string_impl operand). */
+		using policy_type = detail::concat_policy_t<typename lhs_piece::policy, typename rhs_piece::policy>;
+
+		/** @brief Capacity of the materialized string. */
+		static constexpr size_type buffer_capacity = detail::policy_capacity_v<policy_type, reserved_capacity>;
+
+		using result_type = string_impl<buffer_capacity, dynamic_expand_capacity, policy_type>;
+
+		/** @return Number of characters of the concatenated result. */
+		[[nodiscard]] constexpr auto size() const noexcept -> size_type
+		{
+			size_type total = 0;
+			for_each_piece([&total](std::string_view piece) constexpr noexcept { total += piece.size(); });
+			return total;
+		}
+		/** @return Capacity of the materialized string. */
+		[[nodiscard]] constexpr auto capacity() const noexcept -> size_type
+		{
+			return buffer_capacity;
+		}
+		/** @return True if the concatenated result is empty. */
+		[[nodiscard]] constexpr auto empty() const noexcept -> bool
+		{
+			return size() == 0;
+		}
+
+		/**
+		 * @brief Calls @p f with a 'std::string_view' of every operand, left to right.
+		 */
+		template<typename F>
+		constexpr void for_each_piece(F&& f) const noexcept
+		{
+			detail::for_each_concat_piece(*this, f);
+		}
+
+		/**
+		 * @brief Views of every operand, left to right, for scatter-gather output without flattening.
+		 * Literal and 'char' operands are stored in the expression, so it must outlive the views.
+		 */
+		[[nodiscard]] constexpr auto segments() const noexcept -> std::array<std::string_view, piece_count>
+		{
+			std::array<std::string_view, piece_count> result{};
+			std::size_t i = 0;
+			for_each_piece([&result, &i](std::string_view piece) constexpr noexcept { result[i++] = piece; });
+			return result;
+		}
+
+		/**
+		 * @brief Copies all operands into a single string_impl.
+		 * @return A string_impl with capacity 'buffer_capacity'.
+		 */
+		[[nodiscard]] constexpr auto materialize() const noexcept -> result_type
+		{
+			// "string_impl overflow; increase the dynamic buffer size"
+			assert((detail::policy_spills_v<policy_type> && !HYBSTR_IS_CONSTANT_EVALUATED) || size() <= reserved_capacity);
+			return result_type(*this);
+		}
+
+		/** @return A new std::string copy of the concatenated result (runtime). */
+		[[nodiscard]] auto str() const -> std::string
+		{
+			std::string result;
+			result.reserve(size());
+			for_each_piece([&result](std::string_view piece) { result.append(piece); });
+			return result;
+		}
+
+		L _lhs; ///< Left operand.
+		R _rhs; ///< Right operand.
+	};
+
+	template<typename L, typename R>
+	string_impl(const concat_expr<L, R>&) -> string_impl<
+		concat_expr<L, R>::buffer_capacity,
+		concat_expr<L, R>::dynamic_expand_capacity,
+		typename concat_expr<L, R>::policy_type
+	>;
+
+	// ======================================================================
+	//                           Operators
+	// ======================================================================
+
+	/**
+	 * @brief Concatenates two operands.
+	 *
+	 * @details
+	 * At least one operand must be a string_impl or a concat_expr. The other may be a
+	 * string_impl, a concat_expr, a string literal, a char, or anything convertible to 'std::string_view'.
+	 *
+	 * @return With a concat_expr operand, a concat_expr recording both operands (see 'lazy').
+	 * Otherwise a string_impl holding the result, with the capacity that concat_expr describes.
+	 */
+	template<typename L, typename R, detail::enable_concat_t<L, R> = 0>
+	[[nodiscard]] constexpr auto operator+(L&& lhs, R&& rhs) noexcept
+	{
+		if constexpr (detail::is_concat_expr<detail::remove_cvref_t<L>>::value || detail::is_concat_expr<detail::remove_cvref_t<R>>::value)
+		{
+			return concat_expr<detail::concat_storage_t<L>, detail::concat_storage_t<R>>{
+				detail::make_concat_piece<L>(std::forward<L>(lhs)),
+				detail::make_concat_piece<R>(std::forward<R>(rhs))
+			};
+		}
+		else
+		{
+			// Both operands outlive the call, so the expression can refer to them whatever their category.
+			return concat_expr<detail::concat_storage_t<const L&>, detail::concat_storage_t<const R&>>{
+				detail::make_concat_piece<const L&>(lhs),
+				detail::make_concat_piece<const R&>(rhs)
+			}.materialize();
+		}
+	}
+
+	/**
+	 * @brief Starts a lazy concatenation: 'operator+' on the result records its operands instead of copying them.
+	 *
+	 * @details
+	 * 'a + b + c' copies the characters of 'a' into 'a + b', then again into the final string.
+	 * 'lazy(a) + b + c' builds a concat_expr, and the characters are copied once, when it is converted,
+	 * compared or materialized. The expression refers to its lvalue operands; see concat_expr for the
+	 * lifetime rule.
+	 * @code
+	 * hybstr::string_impl key = hybstr::lazy(service) + '.' + route + '.' + status + ".count";
+	 * @endcode
+	 *
+	 * @param str A string_impl (referenced if an lvalue) or a concat_expr (returned as is).
+	 */
+	template<typename T, std::enable_if_t<detail::is_concat_root<detail::remove_cvref_t<T>>::value, int> = 0>
+	[[nodiscard]] constexpr auto lazy(T&& str) noexcept
+	{
+		if constexpr (detail::is_concat_expr<detail::remove_cvref_t<T>>::value)
+		{
+			return detail::remove_cvref_t<T>(std::forward<T>(str));
+		}
+		else
+		{
+			return concat_expr<detail::concat_storage_t<T>, detail::concat_empty>{ detail::make_concat_piece<T>(std::forward<T>(str)), {} };
+		}
+	}
+
+	// ======================================================================
+	//                           Comparisons
+	// =====================================================================
+
+	namespace detail
+	{
+		/**
+		 * @brief Three-way comparison of @p a and @p b, whose characters before @p offset are known to be equal.
+		 * @return Negative, zero or positive.
+		 */
+		constexpr auto compare_tail(const char* a, std::size_t n, const char* b, std::size_t m, std::size_t offset) noexcept -> int
+		{
+			const std::size_t min_size = std::min(n, m);
+			if (min_size > offset)
+			{
+				if (const int cmp = compare_chars(a + offset, b + offset, min_size - offset); cmp != 0)
+				{
+					return cmp;
+				}
+			}
+			return n < m ? -1 : (n > m ? 1 : 0);
+		}
+
+		/**
+		 * @brief Lexicographical three-way comparison of two hybrid strings.
+		 * When both use prefixed_storage, the 8-byte prefixes are compared first as integers.
+		 * @return Negative, zero or positive.
+		 */
+		template<
+			std::size_t B1, std::size_t D1, typename P1,
+			std::size_t B2, std::size_t D2, typename P2
+		>
+		[[nodiscard]] constexpr auto compare_strings(
+			const string_impl<B1, D1, P1>& s1,
+			const string_impl<B2, D2, P2>& s2
+			) noexcept -> int
+		{
+			std::size_t offset = 0;
+			if constexpr (policy_prefixed_v<P1> && policy_prefixed_v<P2>)
+			{
+				const std::uint64_t a = s1._prefix();
+				const std::uint64_t b = s2._prefix();
+				if (a != b)
+				{
+					return a < b ? -1 : 1;
+				}
+				offset = 8;
+			}
+			return compare_tail(s1.data(), s1.size(), s2.data(), s2.size(), offset);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Equality comparison for two hybrid strings.
+	 */
+	template<
+		std::size_t B1, std::size_t D1, typename P1,
+		std::size_t B2, std::size_t D2, typename P2
+	>
+	[[nodiscard]] constexpr bool operator==(
+		const string_impl<B1, D1, P1>& s1,
+		const string_impl<B2, D2, P2>& s2
+		) noexcept
+	{
+		if constexpr (detail::policy_prefixed_v<P1> && detail::policy_prefixed_v<P2>)
+		{
+			return s1.size() == s2.size() && s1._prefix() == s2._prefix() &&
+				(s1.size() <= 8 || detail::equal_chars(s1.data() + 8, s2.data() + 8, s1.size() - 8));
+		}
+		else
+		{
+			return s1.size() == s2.size() && detail::equal_chars(s1.data(), s2.data(), s1.size());
+		}
+	}
+
+
+	/**
+	 * @brief Inequality comparison for two hybrid strings.
+	 */
+	template<
+		std::size_t B1, std::size_t D1, typename P1,
+		std::size_t B2, std::size_t D2, typename P2
+	>
+	[[nodiscard]] constexpr bool operator!=(
+		const string_impl<B1, D1, P1>& s1,
+		const string_impl<B2, D2, P2>& s2
+		) noexcept
+	{
+		return !(s1 == s2);
+	}
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/**
+	 * @brief Lexicographical three-way comparison for hybrid strings. C++20 or above.
+	 */
+	template<
+		std::size_t B1, std::size_t D1, typename P1,
+		std::size_t B2, std::size_t D2, typename P2
+	>
+	[[nodiscard]] constexpr auto operator<=>(
+		const string_impl<B1, D1, P1>& s1,
+		const string_impl<B2, D2, P2>& s2
+		) noexcept
+	{
+		return detail::compare_strings(s1, s2) <=> 0;
+	}
+
+#else
+	/**
+	 * @brief Less than comparison for two hybrid strings. C++17.
+	 */
+	template<
+		std::size_t B1, std::size_t D1, typename P1,
+		std::size_t B2, std::size_t D2, typename P2
+	>
+	[[nodiscard]] constexpr bool operator<(
+		const string_impl<B1, D1, P1>& s1,
+		const string_impl<B2, D2, P2>& s2
+		) noexcept
+	{
+		return detail::compare_strings(s1, s2) < 0;
+	}
+
+	/**
+	 * @brief Less than or equal to comparison for two hybrid strings.
+	 */
+	template<
+		std::size_t B1, std::size_t D1, typename P1,
+		std::size_t B2, std::size_t D2, typename P2
+	>
+	[[nodiscard]] constexpr bool operator<=(
+		const string_impl<B1, D1, P1>& s1,
+		const string_impl<B2, D2, P2>& s2
+		) noexcept
+	{
+		return !(s2 < s1);
+	}
+
+	/**
+	 * @brief Greater than comparison for two hybrid strings.
+	 */
+	template<
+		std::size_t B1, std::size_t D1, typename P1,
+		std::size_t B2, std::size_t D2, typename P2
+	>
+	[[nodiscard]] constexpr bool operator>(
+		const string_impl<B1, D1, P1>& s1,
+		const string_impl<B2, D2, P2>& s2
+		) noexcept
+	{
+		return s2 < s1;
+	}
+
+	/**
+	 * @brief Greater than or equal to comparison for two hybrid strings.
+	 */
+	template<
+		std::size_t B1, std::size_t D1, typename P1,
+		std::size_t B2, std::size_t D2, typename P2
+	>
+	[[nodiscard]] constexpr bool operator>=(
+		const string_impl<B1, D1, P1>& s1,
+		const string_impl<B2, D2, P2>& s2
+	) noexcept
+	{
+		return !(s1 < s2);
+	}
+#endif
+
+	namespace detail
+	{
+		/// @brief Enables comparison operators when one side is a concat_expr and the other a hybstr string.
+		template<typename T1, typename T2>
+		using enable_concat_compare_t = std::enable_if_t<
+			is_concat_root<T1>::value && is_concat_root<T2>::value &&
+			(is_concat_expr<T1>::value || is_concat_expr<T2>::value), int>;
+
+		template<std::size_t B, std::size_t D, typename P>
+		[[nodiscard]] constexpr auto materialize(const string_impl<B, D, P>& s) noexcept -> const string_impl<B, D, P>&
+		{
+			return s;
+		}
+		template<typename L, typename R>
+		[[nodiscard]] constexpr auto materialize(const concat_expr<L, R>& expr) noexcept
+		{
+			return expr.materialize();
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Equality comparison involving a concatenation expression.
+	 */
+	template<typename T1, typename T2, detail::enable_concat_compare_t<T1, T2> = 0>
+	[[nodiscard]] constexpr bool operator==(const T1& lhs, const T2& rhs) noexcept
+	{
+		return detail::materialize(lhs) == detail::materialize(rhs);
+	}
+
+	/**
+	 * @brief Inequality comparison involving a concatenation expression.
+	 */
+	template<typename T1, typename T2, detail::enable_concat_compare_t<T1, T2> = 0>
+	[[nodiscard]] constexpr bool operator!=(const T1& lhs, const T2& rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/**
+	 * @brief Three-way comparison involving a concatenation expression. C++20 or above.
+	 */
+	template<typename T1, typename T2, detail::enable_concat_compare_t<T1, T2> = 0>
+	[[nodiscard]] constexpr auto operator<=>(const T1& lhs, const T2& rhs) noexcept
+	{
+		return detail::materialize(lhs) <=> detail::materialize(rhs);
+	}
+#else
+	/**
+	 * @brief Less than comparison involving a concatenation expression. C++17.
+	 */
+	template<typename T1, typename T2, detail::enable_concat_compare_t<T1, T2> = 0>
+	[[nodiscard]] constexpr bool operator<(const T1& lhs, const T2& rhs) noexcept
+	{
+		return detail::materialize(lhs) < detail::materialize(rhs);
+	}
+
+	/**
+	 * @brief Less than or equal to comparison involving a concatenation expression. C++17.
+	 */
+	template<typename T1, typename T2, detail::enable_concat_compare_t<T1, T2> = 0>
+	[[nodiscard]] constexpr bool operator<=(const T1& lhs, const T2& rhs) noexcept
+	{
+		return !(rhs < lhs);
+	}
+
+	/**
+	 * @brief Greater than comparison involving a concatenation expression. C++17.
+	 */
+	template<typename T1, typename T2, detail::enable_concat_compare_t<T1, T2> = 0>
+	[[nodiscard]] constexpr bool operator>(const T1& lhs, const T2& rhs) noexcept
+	{
+		return rhs < lhs;
+	}
+
+	/**
+	 * @brief Greater than or equal to comparison involving a concatenation expression. C++17.
+	 */
+	template<typename T1, typename T2, detail::enable_concat_compare_t<T1, T2> = 0>
+	[[nodiscard]] constexpr bool operator>=(const T1& lhs, const T2& rhs) noexcept
+	{
+		return !(lhs < rhs);
+	}
+#endif
+
+	// ======================================================================
+	//                           Traits and Utilities
+	// ======================================================================
+
+	/**
+	 * @brief Type trait for detecting hybstr::string_impl.
+	 */
+	template<typename T>
+	struct is_string_impl : std::false_type {};
+	template <std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy>
+	struct is_string_impl<string_impl<BufferCapacity, DynamicExpandCapacity, Policy>> : std::true_type {};
+
+	/// @brief Shorthand boolean variable for is_string_impl.
+	template <typename T>
+	inline constexpr bool is_string_impl_v = is_string_impl<T>::value;
+
+	/**
+	 * @brief Type trait for detecting hybstr::concat_expr.
+	 */
+	template<typename T>
+	struct is_concat_expr : detail::is_concat_expr<T> {};
+
+	/// @brief Shorthand boolean variable for is_concat_expr.
+	template <typename T>
+	inline constexpr bool is_concat_expr_v = is_concat_expr<T>::value;
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/**
+	 * @brief Adjusts the compile-time buffer size to exactly fit the string content. C++20 or above.
+	 *
+	 * @tparam str A hybstr::string_impl or hybstr::concat_expr instance (must be known at compile time).
+	 * @return A new string_impl whose BufferCapacity equals its current size.
+	 */
+	template <auto str>
+	[[nodiscard]] consteval auto fit_string() noexcept
+	{
+		using str_type = std::remove_cvref_t<decltype(str)>;
+		static_assert(is_string_impl_v<str_type> || is_concat_expr_v<str_type>, "Expect a hybstr::string_impl or hybstr::concat_expr as input");
+		if constexpr (is_concat_expr_v<str_type>)
+		{
+			return fit_string<str.materialize()>();
+		}
+		else
+		{
+			return str.template resize<str.size()>();
+		}
+	}
+#endif
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/**
+	 * @brief Adjusts the compile-time buffer size to exactly fit the string content. C++20 or above.
+	 *
+	 * @details
+	 * Returns a resized copy of @p str whose buffer capacity equals its current size.
+	 * The expression is 'constexpr' if @p str supports compile-time evaluation.
+	 *
+	 * @param str A 'hybstr::string_impl' or 'hybstr::concat_expr' instance.
+	 * @return A new 'string_impl' whose buffer capacity matches its current size.
+	 */
+	#define HYBSTR_FIT_STRING(str)\
+		hybstr::fit_string<hybstr::detail::materialize(str)>()
+#else
+	/**
+	 * @brief Adjusts the compile-time buffer size to exactly fit the string content. C++17.
+	 *
+	 * @details
+	 * C++17 fallback macro version of 'hybstr::fit_string'.
+	 * Returns a resized copy of @p str whose buffer capacity equals its current size.
+	 * The expression is 'constexpr' if @p str supports compile-time evaluation.
+	 *
+	 * @param str A 'hybstr::string_impl' or 'hybstr::concat_expr' instance.
+	 * @return A new 'string_impl' whose buffer capacity matches its current size.
+	 */
+	#define HYBSTR_FIT_STRING(str) \
+		([&]() constexpr noexcept { return hybstr::detail::materialize(str).template resize<(str).size()>(); })()
+#endif
+
+	// ======================================================================
+	//                           Sorting
+	// ======================================================================
+
+	namespace detail
+	{
+		/// @brief Runs of fewer elements than this are finished with a comparison sort.
+		inline constexpr std::size_t radix_sort_threshold = 64;
+
+		/** @brief An element during radix_sort: 8 of its characters as a key, and its position in the input. */
+		struct sort_entry
+		{
+			std::uint64_t key;
+			std::size_t index;
+		};
+
+		/** @brief 'prefix_key' of @p s, from a single load at offset 0 with prefixed_storage. */
+		template<std::size_t B, std::size_t D, typename P>
+		[[nodiscard]] constexpr auto string_key(const string_impl<B, D, P>& s, std::size_t offset) noexcept -> std::uint64_t
+		{
+			if constexpr (policy_prefixed_v<P>)
+			{
+				if (offset == 0)
+				{
+					return s._prefix();
+				}
+			}
+			return prefix_key(s.data(), s.size(), offset);
+		}
+
+		/**
+		 * @brief Stable LSD radix sort of @p n entries by key, one byte per pass.
+		 * Passes over a byte that every key shares are skipped. @p scratch has room for @p n entries.
+		 */
+		inline void radix_sort_entries(sort_entry* entries, sort_entry* scratch, std::size_t n) noexcept
+		{
+			std::size_t counts[8][256]{};
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				for (std::size_t byte = 0; byte < 8; ++byte)
+				{
+					++counts[byte][(entries[i].key >> (8 * byte)) & 0xFF];
+				}
+			}
+
+			sort_entry* from = entries;
+			sort_entry* to = scratch;
+			for (std::size_t byte = 0; byte < 8; ++byte)
+			{
+				std::size_t* count = counts[byte];
+				if (count[(from[0].key >> (8 * byte)) & 0xFF] == n)
+				{
+					continue;
+				}
+				std::size_t sum = 0;
+				for (std::size_t digit = 0; digit < 256; ++digit)
+				{
+					const std::size_t c = count[digit];
+					count[digit] = sum;
+					sum += c;
+				}
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					to[count[(from[i].key >> (8 * byte)) & 0xFF]++] = from[i];
+				}
+				std::swap(from, to);
+			}
+			if (from != entries)
+			{
+				std::copy(from, from + n, entries);
+			}
+		}
+
+		template<typename RandomIt>
+		void sort_ties(RandomIt first, sort_entry* entries, sort_entry* scratch, std::size_t n, std::size_t offset);
+
+		/**
+		 * @brief Orders @p n entries whose elements are equal on their first @p offset characters,
+		 * counting the characters past the end of the shorter ones as zero.
+		 */
+		template<typename RandomIt>
+		void sort_run(RandomIt first, sort_entry* entries, sort_entry* scratch, std::size_t n, std::size_t offset)
+		{
+			const bool ended = std::all_of(entries, entries + n, [&](const sort_entry& e) { return first[e.index].size() <= offset; });
+			if (ended)
+			{
+				// Each is a prefix of the longer ones.
+				std::sort(entries, entries + n, [&](const sort_entry& a, const sort_entry& b)
+				{
+					return first[a.index].size() < first[b.index].size();
+				});
+				return;
+			}
+			if (n < radix_sort_threshold)
+			{
+				std::sort(entries, entries + n, [&](const sort_entry& a, const sort_entry& b)
+				{
+					const auto& x = first[a.index];
+					const auto& y = first[b.index];
+					return compare_tail(x.data(), x.size(), y.data(), y.size(), offset) < 0;
+				});
+				return;
+			}
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				entries[i].key = string_key(first[entries[i].index], offset);
+			}
+			radix_sort_entries(entries, scratch, n);
+			sort_ties(first, entries, scratch, n, offset);
+		}
+
+		/** @brief Orders the runs of equal keys in @p n entries sorted by their characters at @p offset. */
+		template<typename RandomIt>
+		void sort_ties(RandomIt first, sort_entry* entries, sort_entry* scratch, std::size_t n, std::size_t offset)
+		{
+			for (std::size_t begin = 0; begin < n;)
+			{
+				std::size_t end = begin + 1;
+				while (end < n && entries[end].key == entries[begin].key)
+				{
+					++end;
+				}
+				if (end - begin > 1)
+				{
+					sort_run(first, entries + begin, scratch + begin, end - begin, offset + 8);
+				}
+				begin = end;
+			}
+		}
+
+		/** @brief Iterator of @p Range, checked to be random access over hybrid strings. */
+		template<typename Range>
+		using sortable_iterator_t = decltype(std::begin(std::declval<Range&>()));
+
+		template<typename Range>
+		constexpr void check_sortable() noexcept
+		{
+			using iterator = sortable_iterator_t<Range>;
+			static_assert(is_string_impl_v<typename std::iterator_traits<iterator>::value_type>,
+				"Expect a range of hybstr::string_impl");
+			static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator>::iterator_category>,
+				"Expect a random access range");
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Sorts a range of hybrid strings in ascending order, in place.
+	 *
+	 * @details
+	 * A comparison sort ('std::sort') that needs no extra memory. With prefixed_storage, most
+	 * comparisons are decided by the 8-byte prefixes alone. Runtime only.
+	 *
+	 * @param range A random access range of one 'string_impl' type ('std::vector', 'std::array', 'std::span', ...).
+	 */
+	template<typename Range>
+	void sort(Range&& range)
+	{
+		detail::check_sortable<Range>();
+		std::sort(std::begin(range), std::end(range), [](const auto& a, const auto& b)
+		{
+			return detail::compare_strings(a, b) < 0;
+		});
+	}
+
+	/**
+	 * @brief Sorts a range of hybrid strings in ascending order with a radix sort on 8-byte keys.
+	 *
+	 * @details
+	 * Sorts (key, position) pairs, keyed on the first 8 characters, with a least significant byte
+	 * first radix sort that skips the bytes all keys share. Runs of equal keys are sorted again on
+	 * the next 8 characters, or with a comparison sort once they are short. The strings are then
+	 * moved into place once each by following the cycles of the permutation.
+	 * Allocates two 16-byte entries per element. Best for large ranges (tens of thousands of
+	 * strings and up) whose keys differ early; small ranges fall back to 'hybstr::sort'. Runtime only.
+	 *
+	 * @param range A random access range of one 'string_impl' type ('std::vector', 'std::array', 'std::span', ...).
+	 */
+	template<typename Range>
+	void radix_sort(Range&& range)
+	{
+		detail::check_sortable<Range>();
+		const auto first = std::begin(range);
+		const std::size_t n = static_cast<std::size_t>(std::end(range) - first);
+		if (n < detail::radix_sort_threshold)
+		{
+			hybstr::sort(range);
+			return;
+		}
+
+		std::vector<detail::sort_entry> entries(n);
+		std::vector<detail::sort_entry> scratch(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			entries[i] = { detail::string_key(first[i], 0), i };
+		}
+		detail::radix_sort_entries(entries.data(), scratch.data(), n);
+		detail::sort_ties(first, entries.data(), scratch.data(), n, 0);
+
+		// Position k receives the element at entries[k].index; placed positions are marked with their own index.
+		for (std::size_t k = 0; k < n; ++k)
+		{
+			if (entries[k].index == k)
+			{
+				continue;
+			}
+			auto held = std::move(first[k]);
+			std::size_t j = k;
+			for (std::size_t src = entries[j].index; src != k; src = entries[j].index)
+			{
+				first[j] = std::move(first[src]);
+				entries[j].index = j;
+				j = src;
+			}
+			first[j] = std::move(held);
+			entries[j].index = j;
+		}
+	}
+
+	// ======================================================================
+	//                           Factory Functions
+	// ======================================================================
+
+	/**
+	 * @brief Creates an empty hybrid string.
+	 */
+	template<std::size_t DynamicExpandCapacity, typename Policy>
+	[[nodiscard]] constexpr auto string()
+	{
+		return string_impl<detail::policy_capacity_v<Policy, 0>, DynamicExpandCapacity, Policy>{};
+	}
+
+	/**
+	 * @brief Creates a hybrid string from a string literal.
+	 */
+	template<std::size_t DynamicExpandCapacity, typename Policy, std::size_t N>
+	[[nodiscard]] constexpr auto string(const char(&str)[N])
+	{
+		constexpr std::size_t capacity = detail::policy_capacity_v<Policy, N - 1>;
+		if constexpr (capacity >= N - 1)
+		{
+			return string_impl<capacity, DynamicExpandCapacity, Policy>{str};
+		}
+		else
+		{
+			return string_impl<capacity, DynamicExpandCapacity, Policy>{std::string_view(str, N - 1)};
+		}
+	}
+
+	/**
+	 * @brief Creates a hybrid string from a std::string_view.
+	 *
+	 * @tparam ViewSize The known or estimated size of the string view.
+	 * @tparam DynamicExpandCapacity Dynamic buffer size for runtime usage.
+	 * @tparam Policy Policy bundle, see default_policy.
+	 */
+	template<std::size_t ViewSize, std::size_t DynamicExpandCapacity, typename Policy>
+	[[nodiscard]] constexpr auto string(std::string_view sv) noexcept
+	{
+		return string_impl<detail::policy_capacity_v<Policy, ViewSize>, DynamicExpandCapacity, Policy>{sv};
+	}
+
+	/**
+	 * @brief Creates a hybrid string from an iterator range.
+	 *
+	 * @tparam RangeSize The known or estimated number of elements in the range.
+	 * @tparam DynamicExpandCapacity Dynamic buffer size for runtime usage.
+	 * @tparam Policy Policy bundle, see default_policy.
+	 * @tparam _Iter Iterator type.
+	 */
+	template<std::size_t RangeSize, std::size_t DynamicExpandCapacity, typename Policy, typename _Iter>
+	[[nodiscard]] constexpr auto string(_Iter start, _Iter end) noexcept
+	{
+		return string_impl<detail::policy_capacity_v<Policy, RangeSize>, DynamicExpandCapacity, Policy>{start, end};
+	}
+
+	// ======================================================================
+	//                           Hashing
+	// ======================================================================
+
+	namespace detail
+	{
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+		/** @brief Loads 8 bytes as a little-endian integer. */
+		constexpr auto load_u64_le(const char* p) noexcept -> std::uint64_t
+		{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_MSC_VER)
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				std::uint64_t v = 0;
+				std::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+#endif
+			std::uint64_t v = 0;
+			for (std::size_t i = 0; i < 8; ++i)
+			{
+				v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+			}
+			return v;
+		}
+
+		/** @brief Loads 4 bytes as a little-endian integer. */
+		constexpr auto load_u32_le(const char* p) noexcept -> std::uint64_t
+		{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_MSC_VER)
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				std::uint32_t v = 0;
+				std::memcpy(&v, p, sizeof(v));
+				return v;
+			}
+#endif
+			std::uint64_t v = 0;
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+			}
+			return v;
+		}
+
+		/** @brief 64x64 -> 128 bit multiplication, returned as (low, high) halves. */
+		constexpr void multiply_128(std::uint64_t& a, std::uint64_t& b) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			const uint128_t r = static_cast<uint128_t>(a) * b;
+			a = static_cast<std::uint64_t>(r);
+			b = static_cast<std::uint64_t>(r >> 64);
+#else
+			const std::uint64_t a_lo = a & 0xffffffffu, a_hi = a >> 32;
+			const std::uint64_t b_lo = b & 0xffffffffu, b_hi = b >> 32;
+			const std::uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+			const std::uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+			const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffu) + lo_hi;
+			a = (cross << 32) | (lo_lo & 0xffffffffu);
+			b = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+#endif
+		}
+
+		/** @brief Multiplies and folds the 128-bit product. */
+		constexpr auto hash_mix(std::uint64_t a, std::uint64_t b) noexcept -> std::uint64_t
+		{
+			multiply_128(a, b);
+			return a ^ b;
+		}
+
+		inline constexpr std::uint64_t hash_secret[4] = {
+			0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+		};
+
+		/** @brief The hash of 'hash_bytes', on the @p len characters at @p p. */
+		constexpr auto hash_chars(const char* p, std::size_t len, std::uint64_t seed) noexcept -> std::uint64_t
+		{
+			std::uint64_t a = 0;
+			std::uint64_t b = 0;
+
+			seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+			if (len <= 16)
+			{
+				if (len >= 4)
+				{
+					const std::size_t shift = (len >> 3) << 2;
+					a = (load_u32_le(p) << 32) | load_u32_le(p + shift);
+					b = (load_u32_le(p + len - 4) << 32) | load_u32_le(p + len - 4 - shift);
+				}
+				else if (len > 0)
+				{
+					a = (static_cast<std::uint64_t>(static_cast<unsigned char>(p[0])) << 16)
+						| (static_cast<std::uint64_t>(static_cast<unsigned char>(p[len >> 1])) << 8)
+						| static_cast<std::uint64_t>(static_cast<unsigned char>(p[len - 1]));
+				}
+			}
+			else
+			{
+				std::size_t i = len;
+				if (i > 48)
+				{
+					std::uint64_t see1 = seed;
+					std::uint64_t see2 = seed;
+					do
+					{
+						seed = hash_mix(load_u64_le(p) ^ hash_secret[1], load_u64_le(p + 8) ^ seed);
+						see1 = hash_mix(load_u64_le(p + 16) ^ hash_secret[2], load_u64_le(p + 24) ^ see1);
+						see2 = hash_mix(load_u64_le(p + 32) ^ hash_secret[3], load_u64_le(p + 40) ^ see2);
+						p += 48;
+						i -= 48;
+					} while (i > 48);
+					seed ^= see1 ^ see2;
+				}
+				while (i > 16)
+				{
+					seed = hash_mix(load_u64_le(p) ^ hash_secret[1], load_u64_le(p + 8) ^ seed);
+					i -= 16;
+					p += 16;
+				}
+				a = load_u64_le(p + i - 16);
+				b = load_u64_le(p + i - 8);
+			}
+
+			a ^= hash_secret[1];
+			b ^= seed;
+			multiply_128(a, b);
+			return hash_mix(a ^ hash_secret[0] ^ len, b ^ hash_secret[1]);
+		}
+
+		/** @brief Runtime hashing of inputs longer than 16 characters. */
+		HYBSTR_NOINLINE inline auto hash_chars_runtime(const char* p, std::size_t len, std::uint64_t seed) noexcept -> std::uint64_t
+		{
+			return hash_chars(p, len, seed);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Hashes a sequence of characters.
+	 *
+	 * @details
+	 * A wyhash-style hash that consumes 8 or 16 bytes per step. It produces the same value in
+	 * constant evaluation and at runtime (where the loads are plain unaligned reads), so hashes
+	 * computed at compile time can be compared with runtime ones.
+	 *
+	 * @param sv Characters to hash.
+	 * @param seed Optional seed.
+	 * @return 64-bit hash value.
+	 */
+	[[nodiscard]] constexpr auto hash_bytes(std::string_view sv, std::uint64_t seed = 0) noexcept -> std::uint64_t
+	{
+		if (!HYBSTR_IS_CONSTANT_EVALUATED && sv.size() > 16)
+		{
+			return detail::hash_chars_runtime(sv.data(), sv.size(), seed);
+		}
+		return detail::hash_chars(sv.data(), sv.size(), seed);
+	}
+
+	/**
+	 * @brief Hashes a hybrid string. Same value as 'hash_bytes(s.view())'.
+	 */
+	template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy>
+	[[nodiscard]] constexpr auto hash_value(const string_impl<BufferCapacity, DynamicExpandCapacity, Policy>& s) noexcept -> std::uint64_t
+	{
+		return hash_bytes(s.view());
+	}
+
+	/**
+	 * @brief A string that carries its hash, computed once (at compile time for constexpr strings).
+	 *
+	 * @tparam String A hybstr::string_impl type.
+	 *
+	 * @code
+	 * constexpr auto key = hybstr::hashed_string(hybstr::string("route.users"));
+	 * static_assert(key.hash() == hybstr::hash_bytes("route.users"));
+	 * @endcode
+	 */
+	template<typename String>
+	class hashed_string
+	{
+		static_assert(is_string_impl_v<String>, "Expect a hybstr::string_impl as input");
+	public:
+		using string_type = String;
+
+		constexpr hashed_string() noexcept
+			: _str(), _hash(hash_value(_str))
+		{
+		}
+		constexpr explicit hashed_string(const String& s) noexcept
+			: _str(s), _hash(hash_value(s))
+		{
+		}
+
+		/** @return The wrapped string. */
+		[[nodiscard]] constexpr auto str() const noexcept -> const String&
+		{
+			return _str;
+		}
+		/** @return Read-only view of the string. */
+		[[nodiscard]] constexpr auto view() const noexcept -> std::string_view
+		{
+			return _str.view();
+		}
+		/** @return The cached hash, equal to 'hash_value(str())'. */
+		[[nodiscard]] constexpr auto hash() const noexcept -> std::uint64_t
+		{
+			return _hash;
+		}
+
+		/** @brief Compares the cached hashes first, then the contents. */
+		template<typename OtherString>
+		[[nodiscard]] constexpr bool operator==(const hashed_string<OtherString>& other) const noexcept
+		{
+			return _hash == other.hash() && view() == other.view();
+		}
+		template<typename OtherString>
+		[[nodiscard]] constexpr bool operator!=(const hashed_string<OtherString>& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+		String _str; ///< Wrapped string.
+		std::uint64_t _hash; ///< Cached hash of '_str'.
+	};
+
+	template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy>
+	hashed_string(const string_impl<BufferCapacity, DynamicExpandCapacity, Policy>&) -> hashed_string<string_impl<BufferCapacity, DynamicExpandCapacity, Policy>>;
+
+	namespace detail
+	{
+		[[nodiscard]] constexpr auto as_view(std::string_view sv) noexcept -> std::string_view
+		{
+			return sv;
+		}
+		template<std::size_t B, std::size_t D, typename P>
+		[[nodiscard]] constexpr auto as_view(const string_impl<B, D, P>& s) noexcept -> std::string_view
+		{
+			return s.view();
+		}
+		template<typename String>
+		[[nodiscard]] constexpr auto as_view(const hashed_string<String>& s) noexcept -> std::string_view
+		{
+			return s.view();
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Transparent hasher for hybrid strings, hashed strings and anything convertible to 'std::string_view'.
+	 *
+	 * @details
+	 * All inputs with the same contents hash to the same value, and hashed_string returns its cached hash.
+	 * Together with hybstr::equal_to it enables heterogeneous lookup (C++20):
+	 * @code
+	 * std::unordered_map<hybstr::string_impl<32>, int, hybstr::hash, hybstr::equal_to> routes;
+	 * routes.find(std::string_view("users"));   // no conversion to the key type
+	 * @endcode
+	 */
+	struct hash
+	{
+		using is_transparent = void;
+
+		[[nodiscard]] constexpr auto operator()(std::string_view sv) const noexcept -> std::size_t
+		{
+			return static_cast<std::size_t>(hash_bytes(sv));
+		}
+		template<std::size_t B, std::size_t D, typename P>
+		[[nodiscard]] constexpr auto operator()(const string_impl<B, D, P>& s) const noexcept -> std::size_t
+		{
+			return static_cast<std::size_t>(hash_value(s));
+		}
+		template<typename String>
+		[[nodiscard]] constexpr auto operator()(const hashed_string<String>& s) const noexcept -> std::size_t
+		{
+			return static_cast<std::size_t>(s.hash());
+		}
+	};
+
+	/**
+	 * @brief Transparent equality for hybrid strings, hashed strings and anything convertible to 'std::string_view'.
+	 */
+	struct equal_to
+	{
+		using is_transparent = void;
+
+		template<typename T1, typename T2>
+		[[nodiscard]] constexpr bool operator()(const T1& lhs, const T2& rhs) const noexcept
+		{
+			return detail::as_view(lhs) == detail::as_view(rhs);
+		}
+	};
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/**
+	 * @brief Hash of a compile-time string, usable as a constant. C++20 or above.
+	 * @tparam str A hybstr::string_impl instance.
+	 */
+	template<auto str>
+	inline constexpr std::uint64_t hash_v = hash_value(str);
+#endif
+
+	// ======================================================================
+	//                           Static Map
+	// ======================================================================
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	namespace detail
+	{
+		/**
+		 * @brief Minimal perfect hash over N keys ("hash and displace").
+		 *
+		 * @details
+		 * A first hash picks a bucket. Each bucket stores either a seed for a second hash, or,
+		 * for buckets holding a single key, the slot directly (encoded as a negative number).
+		 * Every key ends up in its own slot, so a lookup costs one or two hashes and a single key comparison.
+		 */
+		template<std::size_t N>
+		struct perfect_hash
+		{
+			static constexpr std::size_t table_size = bit_ceil(N);
+			static constexpr std::size_t mask = table_size - 1;
+			static constexpr std::uint32_t empty = static_cast<std::uint32_t>(N);
+
+			/** @return Index of the only key that may equal @p sv, or N. */
+			[[nodiscard]] constexpr auto candidate(std::string_view sv) const noexcept -> std::size_t
+			{
+				const std::int32_t d = displacement[hash_bytes(sv) & mask];
+				const std::size_t slot = d < 0
+					? static_cast<std::size_t>(-d - 1)
+					: static_cast<std::size_t>(hash_bytes(sv, static_cast<std::uint64_t>(d)) & mask);
+				return slots[slot];
+			}
+
+			std::array<std::int32_t, table_size> displacement{}; ///< Per bucket: seed, or -(slot + 1).
+			std::array<std::uint32_t, table_size> slots{};       ///< Per slot: key index, or N if empty.
+		};
+
+		template<std::size_t N>
+		consteval auto make_perfect_hash(const std::array<std::string_view, N>& keys) -> perfect_hash<N>
+		{
+			using table = perfect_hash<N>;
+			constexpr std::size_t size = table::table_size;
+
+			perfect_hash<N> result{};
+			result.slots.fill(table::empty);
+
+			std::array<std::size_t, N> bucket_of{};
+			std::array<std::size_t, size> bucket_size{};
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				bucket_of[i] = hash_bytes(keys[i]) & table::mask;
+				++bucket_size[bucket_of[i]];
+			}
+
+			// Buckets in decreasing size.
+			std::array<std::size_t, size> order{};
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				order[i] = i;
+			}
+			for (std::size_t i = 1; i < size; ++i)
+			{
+				for (std::size_t j = i; j > 0 && bucket_size[order[j - 1]] < bucket_size[order[j]]; --j)
+				{
+					std::swap(order[j - 1], order[j]);
+				}
+			}
+
+			std::size_t next_free = 0;
+			for (const std::size_t bucket : order)
+			{
+				if (bucket_size[bucket] == 0)
+				{
+					break;
+				}
+
+				std::array<std::size_t, N> members{};
+				std::size_t count = 0;
+				for (std::size_t i = 0; i < N; ++i)
+				{
+					if (bucket_of[i] == bucket)
+					{
+						members[count++] = i;
+					}
+				}
+
+				if (count == 1)
+				{
+					while (result.slots[next_free] != table::empty)
+					{
+						++next_free;
+					}
+					result.slots[next_free] = static_cast<std::uint32_t>(members[0]);
+					result.displacement[bucket] = -static_cast<std::int32_t>(next_free) - 1;
+					continue;
+				}
+
+				for (std::int32_t d = 1;; ++d)
+				{
+					if (d == std::numeric_limits<std::int32_t>::max())
+					{
+						throw "hybstr::static_map: could not build a perfect hash";
+					}
+
+					std::array<std::size_t, N> placed{};
+					bool ok = true;
+					for (std::size_t m = 0; m < count && ok; ++m)
+					{
+						placed[m] = hash_bytes(keys[members[m]], static_cast<std::uint64_t>(d)) & table::mask;
+						ok = result.slots[placed[m]] == table::empty;
+						for (std::size_t k = 0; k < m && ok; ++k)
+						{
+							ok = placed[k] != placed[m];
+						}
+					}
+					if (ok)
+					{
+						for (std::size_t m = 0; m < count; ++m)
+						{
+							result.slots[placed[m]] = static_cast<std::uint32_t>(members[m]);
+						}
+						result.displacement[bucket] = d;
+						break;
+					}
+				}
+			}
+			return result;
+		}
+
+		template<std::size_t N>
+		consteval bool all_distinct(const std::array<std::string_view, N>& keys)
+		{
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				for (std::size_t j = i + 1; j < N; ++j)
+				{
+					if (keys[i] == keys[j])
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Immutable map from compile-time string keys to values, backed by a minimal perfect hash. C++20 or above.
+	 *
+	 * @tparam Value Mapped type.
+	 * @tparam Keys hybstr::string_impl keys (e.g. '"key"_hyb'), all distinct.
+	 *
+	 * @details
+	 * The hash table is built during constant evaluation. A runtime lookup hashes the input once
+	 * or twice and compares it with a single candidate key. Nothing is allocated.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * constexpr hybstr::static_map<int, "GET"_hyb, "PUT"_hyb, "POST"_hyb> methods{ 1, 2, 3 };
+	 *
+	 * static_assert(*methods.find("PUT") == 2);
+	 * static_assert(methods.find("PATCH") == nullptr);
+	 * @endcode
+	 */
+	template<typename Value, auto... Keys>
+	class static_map
+	{
+		static_assert((is_string_impl_v<std::remove_cvref_t<decltype(Keys)>> && ...), "Expect hybstr::string_impl keys");
+
+		static constexpr std::size_t key_count = sizeof...(Keys);
+		static constexpr std::array<std::string_view, key_count> _keys{ Keys.view()... };
+		static_assert(detail::all_distinct(_keys), "static_map keys must be distinct");
+		static constexpr detail::perfect_hash<key_count> _table = detail::make_perfect_hash(_keys);
+	public:
+		using key_type = std::string_view;
+		using mapped_type = Value;
+		using size_type = std::size_t;
+
+		/// @brief Returned by index_of when the key is missing.
+		static constexpr size_type npos = static_cast<size_type>(-1);
+
+		/** @brief Value-initializes every value. */
+		constexpr static_map() = default;
+		/** @brief Initializes the values in the order of the keys. */
+		constexpr explicit static_map(const std::array<Value, key_count>& values)
+			: _values(values)
+		{
+		}
+		/** @brief Initializes the values in the order of the keys. */
+		template<typename... Args, std::enable_if_t<sizeof...(Args) == key_count && key_count != 0
+			&& !(std::is_same_v<detail::remove_cvref_t<Args>, static_map> || ...), int> = 0>
+		constexpr static_map(Args&&... values)
+			: _values{ Value(std::forward<Args>(values))... }
+		{
+		}
+
+		/** @return Number of keys. */
+		[[nodiscard]] static constexpr auto size() noexcept -> size_type
+		{
+			return key_count;
+		}
+		/** @return The i-th key. */
+		[[nodiscard]] static constexpr auto key(size_type i) noexcept -> key_type
+		{
+			return _keys[i];
+		}
+		/** @return Position of @p sv among the keys, or npos. */
+		[[nodiscard]] static constexpr auto index_of(std::string_view sv) noexcept -> size_type
+		{
+			if constexpr (key_count == 0)
+			{
+				return npos;
+			}
+			else
+			{
+				const std::size_t i = _table.candidate(sv);
+				if (i < key_count && _keys[i].size() == sv.size() && detail::equal_chars(_keys[i].data(), sv.data(), sv.size()))
+				{
+					return i;
+				}
+				return npos;
+			}
+		}
+		/** @return True if @p sv is one of the keys. */
+		[[nodiscard]] static constexpr auto contains(std::string_view sv) noexcept -> bool
+		{
+			return index_of(sv) != npos;
+		}
+
+		/** @return Pointer to the value of @p sv, or nullptr. */
+		[[nodiscard]] constexpr auto find(std::string_view sv) noexcept -> Value*
+		{
+			const size_type i = index_of(sv);
+			return i == npos ? nullptr : &_values[i];
+		}
+		/** @return Pointer to the value of @p sv, or nullptr. */
+		[[nodiscard]] constexpr auto find(std::string_view sv) const noexcept -> const Value*
+		{
+			const size_type i = index_of(sv);
+			return i == npos ? nullptr : &_values[i];
+		}
+		/** @return Value of @p sv. Throws std::out_of_range if missing. */
+		[[nodiscard]] constexpr auto at(std::string_view sv) const -> const Value&
+		{
+			const Value* value = find(sv);
+			if (!value)
+			{
+				throw std::out_of_range("hybstr::static_map::at");
+			}
+			return *value;
+		}
+		/** @return The i-th value. */
+		[[nodiscard]] constexpr auto value(size_type i) const noexcept -> const Value&
+		{
+			return _values[i];
+		}
+
+		std::array<Value, key_count> _values{}; ///< Values, in the order of the keys.
+	};
+#endif
+
+	// ======================================================================
+	//                           Prefix Router
+	// ======================================================================
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	namespace detail
+	{
+		/** @brief Unaligned load of a @p T from @p p. */
+		template<typename T>
+		inline auto load_unaligned(const char* p) noexcept -> T
+		{
+			T value;
+			std::memcpy(&value, p, sizeof(T));
+			return value;
+		}
+
+		/**
+		 * @brief equal_chars for short runtime lengths: overlapping 8-byte (or 4-byte) loads instead of a memcmp call.
+		 */
+		constexpr auto equal_words(const char* a, const char* b, std::size_t n) noexcept -> bool
+		{
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				return equal_chars(a, b, n);
+			}
+			if (n >= 8)
+			{
+				for (std::size_t i = 0; i + 8 < n; i += 8)
+				{
+					if (load_unaligned<std::uint64_t>(a + i) != load_unaligned<std::uint64_t>(b + i))
+					{
+						return false;
+					}
+				}
+				return load_unaligned<std::uint64_t>(a + n - 8) == load_unaligned<std::uint64_t>(b + n - 8);
+			}
+			if (n >= 4)
+			{
+				return load_unaligned<std::uint32_t>(a) == load_unaligned<std::uint32_t>(b)
+					&& load_unaligned<std::uint32_t>(a + n - 4) == load_unaligned<std::uint32_t>(b + n - 4);
+			}
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				if (a[i] != b[i])
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/** @brief Node of a flattened prefix trie. The children of a node are stored next to each other. */
+		struct prefix_node
+		{
+			std::uint32_t label = 0;        ///< Offset of the edge label in the label pool.
+			std::uint32_t label_length = 0; ///< Length of the edge label (0 for the root).
+			std::uint32_t first_child = 0;  ///< Index of the first child.
+			std::uint32_t child_count = 0;  ///< Number of children.
+			std::uint32_t route = 0;        ///< Route ending at this node, or the route count if none.
+		};
+
+		/**
+		 * @brief Compressed (Patricia) trie in breadth-first order.
+		 * Edge labels live in one character pool, and the first label character of every node is kept
+		 * in a separate array so a child lookup scans contiguous bytes.
+		 */
+		template<std::size_t Nodes, std::size_t Pool>
+		struct prefix_trie
+		{
+			std::array<prefix_node, Nodes> nodes{};
+			std::array<char, Nodes> first{};
+			std::array<char, Pool> pool{};
+			std::size_t node_count = 0;
+			std::size_t pool_size = 0;
+		};
+
+		/**
+		 * @brief Builds the trie of @p routes into worst-case sized arrays.
+		 *
+		 * @details
+		 * Once sorted, the routes below any trie node form a contiguous range, and the shortest of them
+		 * comes first. Each node is expanded by splitting its range on the next character, and every
+		 * child label runs to the longest prefix shared by its range (that of its first and last routes).
+		 */
+		template<std::size_t N, std::size_t Nodes, std::size_t Pool>
+		consteval auto make_prefix_trie(const std::array<std::string_view, N>& routes) -> prefix_trie<Nodes, Pool>
+		{
+			std::array<std::size_t, N> order{};
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				order[i] = i;
+			}
+			for (std::size_t i = 1; i < N; ++i)
+			{
+				for (std::size_t j = i; j > 0 && routes[order[j]] < routes[order[j - 1]]; --j)
+				{
+					std::swap(order[j - 1], order[j]);
+				}
+			}
+
+			struct range
+			{
+				std::size_t lo = 0;
+				std::size_t hi = 0;
+				std::size_t depth = 0;
+			};
+			std::array<range, Nodes> ranges{};
+			prefix_trie<Nodes, Pool> result{};
+			result.nodes[0].route = static_cast<std::uint32_t>(N);
+			ranges[0] = { 0, N, 0 };
+			result.node_count = 1;
+
+			for (std::size_t n = 0; n < result.node_count; ++n)
+			{
+				auto [lo, hi, depth] = ranges[n];
+				if (lo < hi && routes[order[lo]].size() == depth)
+				{
+					result.nodes[n].route = static_cast<std::uint32_t>(order[lo++]);
+				}
+				result.nodes[n].first_child = static_cast<std::uint32_t>(result.node_count);
+
+				while (lo < hi)
+				{
+					const std::string_view head = routes[order[lo]];
+					std::size_t end = lo + 1;
+					while (end < hi && routes[order[end]][depth] == head[depth])
+					{
+						++end;
+					}
+					const std::string_view tail = routes[order[end - 1]];
+					std::size_t common = depth + 1;
+					while (common < head.size() && common < tail.size() && head[common] == tail[common])
+					{
+						++common;
+					}
+
+					const std::size_t child = result.node_count++;
+					result.nodes[child].label = static_cast<std::uint32_t>(result.pool_size);
+					result.nodes[child].label_length = static_cast<std::uint32_t>(common - depth);
+					result.nodes[child].route = static_cast<std::uint32_t>(N);
+					result.first[child] = head[depth];
+					for (std::size_t i = depth; i < common; ++i)
+					{
+						result.pool[result.pool_size++] = head[i];
+					}
+					ranges[child] = { lo, end, common };
+					++result.nodes[n].child_count;
+					lo = end;
+				}
+			}
+			return result;
+		}
+
+		/** @brief Copies @p trie into arrays of exactly the used size. */
+		template<std::size_t Nodes, std::size_t Pool, typename Trie>
+		consteval auto shrink_prefix_trie(const Trie& trie) -> prefix_trie<Nodes, Pool>
+		{
+			prefix_trie<Nodes, Pool> result{};
+			for (std::size_t i = 0; i < Nodes; ++i)
+			{
+				result.nodes[i] = trie.nodes[i];
+				result.first[i] = trie.first[i];
+			}
+			for (std::size_t i = 0; i < Pool; ++i)
+			{
+				result.pool[i] = trie.pool[i];
+			}
+			result.node_count = Nodes;
+			result.pool_size = Pool;
+			return result;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Longest-prefix matcher over compile-time routes. C++20 or above.
+	 *
+	 * @tparam Routes hybstr::string_impl prefixes (e.g. '"/api/"_hyb'), all distinct.
+	 *
+	 * @details
+	 * The routes are compiled into a flattened compressed trie. A lookup walks it once: at each node
+	 * it picks the child by its first character, then checks the rest of the edge label with word-sized
+	 * compares. The cost depends on the length of the path, not on the number of routes.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * using router = hybstr::prefix_router<"/api/"_hyb, "/api/v2/"_hyb, "/static/"_hyb>;
+	 *
+	 * static_assert(router::route("/api/v2/users") == 1);
+	 * static_assert(router::route("/api/v1/users") == 0);
+	 * static_assert(router::route("/index.html") == router::npos);
+	 * @endcode
+	 */
+	template<auto... Routes>
+	class prefix_router
+	{
+		static_assert((is_string_impl_v<std::remove_cvref_t<decltype(Routes)>> && ...), "Expect hybstr::string_impl routes");
+
+		static constexpr std::size_t route_count = sizeof...(Routes);
+		static constexpr std::array<std::string_view, route_count> _routes{ Routes.view()... };
+		static_assert(detail::all_distinct(_routes), "prefix_router routes must be distinct");
+
+		static constexpr auto _built = detail::make_prefix_trie<route_count, 2 * route_count + 1, (Routes.size() + ... + 0)>(_routes);
+		static constexpr auto _trie = detail::shrink_prefix_trie<_built.node_count, _built.pool_size>(_built);
+	public:
+		using size_type = std::size_t;
+
+		/// @brief Returned by route when no prefix matches.
+		static constexpr size_type npos = static_cast<size_type>(-1);
+
+		/** @return Number of routes. */
+		[[nodiscard]] static constexpr auto size() noexcept -> size_type
+		{
+			return route_count;
+		}
+		/** @return The i-th route. */
+		[[nodiscard]] static constexpr auto prefix(size_type i) noexcept -> std::string_view
+		{
+			return _routes[i];
+		}
+		/** @return Number of trie nodes, the root included. */
+		[[nodiscard]] static constexpr auto node_count() noexcept -> size_type
+		{
+			return _trie.node_count;
+		}
+
+		/** @return Position (in the template argument list) of the longest route that is a prefix of @p path, or npos. */
+		[[nodiscard]] static constexpr auto route(std::string_view path) noexcept -> size_type
+		{
+			size_type best = npos;
+			std::size_t pos = 0;
+			std::size_t node = 0;
+			for (;;)
+			{
+				const detail::prefix_node& current = _trie.nodes[node];
+				if (current.route != route_count)
+				{
+					best = current.route;
+				}
+				if (pos == path.size() || current.child_count == 0)
+				{
+					break;
+				}
+
+				const char c = path[pos];
+				const std::size_t end = current.first_child + current.child_count;
+				std::size_t next = current.first_child;
+				while (next < end && _trie.first[next] != c)
+				{
+					++next;
+				}
+				if (next == end)
+				{
+					break;
+				}
+				node = next;
+				const detail::prefix_node& child = _trie.nodes[node];
+				if (path.size() - pos < child.label_length
+					|| !detail::equal_words(path.data() + pos, _trie.pool.data() + child.label, child.label_length))
+				{
+					break;
+				}
+				pos += child.label_length;
+			}
+			return best;
+		}
+		/** @return True if some route is a prefix of @p path. */
+		[[nodiscard]] static constexpr auto matches(std::string_view path) noexcept -> bool
+		{
+			return route(path) != npos;
+		}
+	};
+#endif
+
+	// ======================================================================
+	//                           Interning
+	// ======================================================================
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	namespace detail
+	{
+		/** @brief Fitted copy of @p str with the default expand capacity and policy, so equal contents give equal values. */
+		template<auto str>
+		consteval auto canonical_string() noexcept
+		{
+			constexpr auto fitted = fit_string<str>();
+			return string_impl<fitted.size()>(fitted.view());
+		}
+
+		/** @brief One instance per distinct canonical string. */
+		template<auto canonical>
+		struct interned_pool
+		{
+			static constexpr auto value = canonical;
+			static constexpr std::string_view view = value.view();
+		};
+	} // namespace detail
+
+	/**
+	 * @brief Returns the pooled instance for the contents of @p str. C++20 or above.
+	 *
+	 * @details
+	 * There is a single 'static constexpr' fitted instance per distinct contents, whatever the
+	 * capacity or policy of @p str. Every call with the same contents returns a reference to the same object.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * static_assert(&hybstr::intern<"cpu"_hyb>() == &hybstr::intern<hybstr::string<64>("cpu")>());
+	 * @endcode
+	 *
+	 * @tparam str A hybstr::string_impl or hybstr::concat_expr instance.
+	 */
+	template<auto str>
+	[[nodiscard]] constexpr auto intern() noexcept -> const auto&
+	{
+		return detail::interned_pool<detail::canonical_string<str>()>::value;
+	}
+
+	/**
+	 * @brief Pointer-sized handle to an interned string. C++20 or above.
+	 *
+	 * @details
+	 * Two handles compare equal exactly when they refer to the same contents, which is a single pointer comparison.
+	 * A default-constructed handle refers to the empty string.
+	 * Handles obtained in different shared objects that do not share symbols may not compare equal.
+	 */
+	class interned_ref
+	{
+	public:
+		constexpr interned_ref() noexcept
+			: _entry(&detail::interned_pool<string_impl<0>{}>::view)
+		{
+		}
+		constexpr explicit interned_ref(const std::string_view* entry) noexcept
+			: _entry(entry)
+		{
+		}
+
+		/** @return View of the interned contents. */
+		[[nodiscard]] constexpr auto view() const noexcept -> std::string_view
+		{
+			return *_entry;
+		}
+		/** @return Pointer to the interned characters, null-terminated. */
+		[[nodiscard]] constexpr auto c_str() const noexcept -> const char*
+		{
+			return _entry->data();
+		}
+		/** @return Pointer to the interned characters. */
+		[[nodiscard]] constexpr auto data() const noexcept -> const char*
+		{
+			return _entry->data();
+		}
+		/** @return Length of the interned contents. */
+		[[nodiscard]] constexpr auto size() const noexcept -> std::size_t
+		{
+			return _entry->size();
+		}
+		/** @return True if the interned contents are empty. */
+		[[nodiscard]] constexpr auto empty() const noexcept -> bool
+		{
+			return _entry->empty();
+		}
+		[[nodiscard]] constexpr operator std::string_view() const noexcept
+		{
+			return *_entry;
+		}
+
+		[[nodiscard]] friend constexpr auto operator==(interned_ref lhs, interned_ref rhs) noexcept -> bool
+		{
+			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				// Addresses of distinct pooled objects are not comparable in constant expressions on every compiler;
+				// the pool is unique per contents, so comparing contents gives the same answer.
+				return *lhs._entry == *rhs._entry;
+			}
+			return lhs._entry == rhs._entry;
+		}
+
+		const std::string_view* _entry; ///< Pooled view, unique per contents.
+	};
+
+	/**
+	 * @brief Returns a handle to the pooled instance for the contents of @p str. C++20 or above.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * constexpr hybstr::interned_ref tag = hybstr::intern_ref<"cpu"_hyb>();
+	 * static_assert(tag == hybstr::intern_ref<"cpu"_hyb>());
+	 * @endcode
+	 */
+	template<auto str>
+	[[nodiscard]] constexpr auto intern_ref() noexcept -> interned_ref
+	{
+		return interned_ref(&detail::interned_pool<detail::canonical_string<str>()>::view);
+	}
+#endif
+
+	// ======================================================================
+	//                           Compression
+	// ======================================================================
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	namespace detail
+	{
+		/*
+		 * LZ77 block format, as in LZ4: each sequence is a token byte (literal count in the high
+		 * nibble, match length minus lz_min_match in the low one, 15 meaning that 255-terminated
+		 * extension bytes follow), the literals, a 2-byte little-endian offset and the match length
+		 * extension. The last sequence stops after its literals.
+		 */
+
+		/// @brief Shortest match worth a sequence.
+		inline constexpr std::size_t lz_min_match = 4;
+
+		/// @brief Farthest back a match may start. Also the chunk size of 'compressed_string::stream'.
+		inline constexpr std::size_t lz_window = std::size_t{ 1 } << 14;
+
+		/// @brief log2 of the number of match candidates the encoder remembers.
+		inline constexpr std::size_t lz_hash_bits = 12;
+
+		[[nodiscard]] consteval auto lz_load32(const char* p) noexcept -> std::uint32_t
+		{
+			return static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) |
+				static_cast<std::uint32_t>(static_cast<unsigned char>(p[1])) << 8 |
+				static_cast<std::uint32_t>(static_cast<unsigned char>(p[2])) << 16 |
+				static_cast<std::uint32_t>(static_cast<unsigned char>(p[3])) << 24;
+		}
+
+		[[nodiscard]] consteval auto lz_hash(std::uint32_t word) noexcept -> std::size_t
+		{
+			return static_cast<std::uint32_t>(word * 2654435761u) >> (32 - lz_hash_bits);
+		}
+
+		/**
+		 * @brief Greedy LZ77 encoding of the @p n characters at @p in, with a single hash-table candidate per position.
+		 * @param out Receives the encoded bytes, or nullptr to only count them.
+		 * @return Size of the encoded block.
+		 */
+		consteval auto lz_encode(const char* in, std::size_t n, char* out) noexcept -> std::size_t
+		{
+			std::size_t size = 0;
+			const auto put = [&](std::size_t byte)
+			{
+				if (out != nullptr)
+				{
+					out[size] = static_cast<char>(static_cast<unsigned char>(byte));
+				}
+				++size;
+			};
+			const auto put_extension = [&](std::size_t extra)
+			{
+				for (; extra >= 255; extra -= 255)
+				{
+					put(255);
+				}
+				put(extra);
+			};
+			const auto put_literals = [&](std::size_t first, std::size_t last, std::size_t match_code)
+			{
+				const std::size_t count = last - first;
+				put(std::min<std::size_t>(count, 15) << 4 | std::min<std::size_t>(match_code, 15));
+				if (count >= 15)
+				{
+					put_extension(count - 15);
+				}
+				for (std::size_t k = first; k < last; ++k)
+				{
+					put(static_cast<unsigned char>(in[k]));
+				}
+			};
+
+			std::array<std::size_t, std::size_t{ 1 } << lz_hash_bits> table{}; // position + 1, 0 when empty
+			std::size_t anchor = 0;
+			std::size_t i = 0;
+			while (i + lz_min_match <= n)
+			{
+				const std::uint32_t word = lz_load32(in + i);
+				const std::size_t candidate = table[lz_hash(word)];
+				table[lz_hash(word)] = i + 1;
+				if (candidate == 0 || i - (candidate - 1) > lz_window || lz_load32(in + candidate - 1) != word)
+				{
+					++i;
+					continue;
+				}
+
+				const std::size_t from = candidate - 1;
+				std::size_t length = lz_min_match;
+				while (i + length < n && in[from + length] == in[i + length])
+				{
+					++length;
+				}
+				const std::size_t match_code = length - lz_min_match;
+				put_literals(anchor, i, match_code);
+				put((i - from) & 0xFF);
+				put((i - from) >> 8);
+				if (match_code >= 15)
+				{
+					put_extension(match_code - 15);
+				}
+
+				for (std::size_t j = i + 1; j < i + length && j + lz_min_match <= n; ++j)
+				{
+					table[lz_hash(lz_load32(in + j))] = j + 1;
+				}
+				i += length;
+				anchor = i;
+			}
+			put_literals(anchor, n, 0);
+			return size;
+		}
+
+		/**
+		 * @brief Walks the sequences of the @p n encoded bytes at @p in, passing each literal run
+		 * to @p literals(const char*, count) and each match to @p match(offset, length).
+		 */
+		template<typename Literals, typename Match>
+		constexpr void lz_parse(const char* in, std::size_t n, Literals&& literals, Match&& match) noexcept
+		{
+			const char* const end = in + n;
+			const auto extension = [&](std::size_t count)
+			{
+				unsigned char byte = 255;
+				while (byte == 255)
+				{
+					byte = static_cast<unsigned char>(*in++);
+					count += byte;
+				}
+				return count;
+			};
+			while (in < end)
+			{
+				const auto token = static_cast<unsigned char>(*in++);
+				std::size_t count = token >> 4;
+				if (count == 15)
+				{
+					count = extension(count);
+				}
+				literals(in, count);
+				in += count;
+				if (in == end)
+				{
+					break;
+				}
+				const std::size_t offset = static_cast<unsigned char>(in[0]) | static_cast<std::size_t>(static_cast<unsigned char>(in[1])) << 8;
+				in += 2;
+				std::size_t length = token & 15;
+				if (length == 15)
+				{
+					length = extension(length);
+				}
+				match(offset, length + lz_min_match);
+			}
+		}
+
+		/** @brief Decodes the @p n bytes at @p in to @p out, which has room for the decoded size. */
+		constexpr void lz_decode(const char* in, std::size_t n, char* out) noexcept
+		{
+			lz_parse(in, n,
+				[&](const char* literals, std::size_t count)
+				{
+					copy_chars(out, literals, count);
+					out += count;
+				},
+				[&](std::size_t offset, std::size_t length)
+				{
+					const char* from = out - offset;
+					if (offset >= length)
+					{
+						copy_chars(out, from, length);
+					}
+					else
+					{
+						// Overlapping: the match repeats its last 'offset' characters.
+						for (std::size_t k = 0; k < length; ++k)
+						{
+							out[k] = from[k];
+						}
+					}
+					out += length;
+				});
+		}
+
+		/** @brief Encoded 'Str', sized exactly. */
+		template<auto Str>
+		consteval auto lz_block() noexcept
+		{
+			constexpr auto str = materialize(Str);
+			std::array<char, lz_encode(str.data(), str.size(), nullptr)> out{};
+			lz_encode(str.data(), str.size(), out.data());
+			return out;
+		}
+
+		/** @brief Decoded characters of a compressed_string, filled on construction. */
+		template<std::size_t N>
+		struct lz_cache
+		{
+			lz_cache(const char* in, std::size_t n) noexcept
+			{
+				lz_decode(in, n, data);
+				data[N] = '\0';
+			}
+
+			char data[N + 1];
+		};
+	} // namespace detail
+
+	/**
+	 * @brief Contents of a compile-time string kept LZ77-compressed in the binary. C++20 or above.
+	 *
+	 * @details
+	 * Only the compressed block is emitted; the source string is used in constant evaluation only.
+	 * 'view()' decompresses once, on first use, into a static buffer that takes no space in the binary.
+	 * 'stream()' decompresses into a small stack buffer instead, one chunk at a time.
+	 * Created with 'hybstr::compressed<str>()'. All members are static.
+	 *
+	 * @tparam Str A hybstr::string_impl or hybstr::concat_expr instance.
+	 */
+	template<auto Str>
+	class compressed_string
+	{
+		static constexpr auto _block = detail::lz_block<Str>();
+		static constexpr std::size_t _size = detail::materialize(Str).size();
+
+	public:
+		/** @return Number of characters once decompressed. */
+		[[nodiscard]] static constexpr auto size() noexcept -> std::size_t
+		{
+			return _size;
+		}
+
+		/** @return Number of bytes embedded in the binary. */
+		[[nodiscard]] static constexpr auto compressed_size() noexcept -> std::size_t
+		{
+			return _block.size();
+		}
+
+		/** @return The compressed block. */
+		[[nodiscard]] static constexpr auto compressed_data() noexcept -> std::string_view
+		{
+			return std::string_view(_block.data(), _block.size());
+		}
+
+		/**
+		 * @brief Decompressed contents, null-terminated. Runtime only.
+		 * Decompresses on the first call (thread-safe); later calls return the same view.
+		 */
+		[[nodiscard]] static auto view() noexcept -> std::string_view
+		{
+			static const detail::lz_cache<_size> cache(_block.data(), _block.size());
+			return std::string_view(cache.data, _size);
+		}
+
+		/** @return Pointer to the null-terminated decompressed contents. Same as 'view().data()'. */
+		[[nodiscard]] static auto c_str() noexcept -> const char*
+		{
+			return view().data();
+		}
+
+		/**
+		 * @brief Decompresses into @p out, which has room for 'size()' characters. No terminator is written.
+		 * Does not use the cached buffer.
+		 */
+		static constexpr void copy_to(char* out) noexcept
+		{
+			detail::lz_decode(_block.data(), _block.size(), out);
+		}
+
+		/**
+		 * @brief Decompresses in chunks of up to 16 KiB, passing each to @p sink as a 'std::string_view'.
+		 *
+		 * @details
+		 * Uses a 32 KiB stack buffer instead of the cached one, for contents that are written out once
+		 * (to a socket, a file, a hash) and need not stay in memory. A chunk is only valid during the call.
+		 * Runtime only.
+		 */
+		template<typename Sink>
+		static void stream(Sink&& sink)
+		{
+			constexpr std::size_t ring_size = 2 * detail::lz_window;
+			constexpr std::size_t mask = ring_size - 1;
+			char ring[ring_size];
+			std::size_t produced = 0;
+			std::size_t flushed = 0;
+
+			// The unflushed part never wraps: 'flushed' is a multiple of lz_window and stays within one window of 'produced'.
+			const auto flush = [&]()
+			{
+				sink(std::string_view(ring + (flushed & mask), produced - flushed));
+				flushed = produced;
+			};
+			const auto step = [&](std::size_t count)
+			{
+				return std::min(count, detail::lz_window - (produced - flushed));
+			};
+			detail::lz_parse(_block.data(), _block.size(),
+				[&](const char* literals, std::size_t count)
+				{
+					while (count != 0)
+					{
+						const std::size_t n = step(count);
+						std::memcpy(ring + (produced & mask), literals, n);
+						literals += n;
+						count -= n;
+						produced += n;
+						if (produced - flushed == detail::lz_window)
+						{
+							flush();
+						}
+					}
+				},
+				[&](std::size_t offset, std::size_t length)
+				{
+					while (length != 0)
+					{
+						const std::size_t n = step(length);
+						char* out = ring + (produced & mask);
+						const std::size_t from = (produced - offset) & mask;
+						if (offset >= n && from + n <= ring_size)
+						{
+							std::memcpy(out, ring + from, n);
+						}
+						else
+						{
+							for (std::size_t k = 0; k < n; ++k)
+							{
+								out[k] = ring[(from + k) & mask];
+							}
+						}
+						length -= n;
+						produced += n;
+						if (produced - flushed == detail::lz_window)
+						{
+							flush();
+						}
+					}
+				});
+			if (produced != flushed)
+			{
+				flush();
+			}
+		}
+	};
+
+	/**
+	 * @brief Compresses the contents of @p Str at compile time. C++20 or above.
+	 *
+	 * @details
+	 * For large templates and schemas that would otherwise be embedded at full 'BufferCapacity + 1'.
+	 * The source string is only read during constant evaluation, so it is not emitted.
+	 * @code
+	 * constexpr auto schema = hybstr::compressed<big_schema>();
+	 * std::string_view text = schema.view(); // decompressed once, on first use
+	 * @endcode
+	 * Inputs of a few hundred kilobytes can exceed the default constant evaluation limits
+	 * ('-fconstexpr-ops-limit' and '-fconstexpr-loop-limit' for GCC, '-fconstexpr-steps' for Clang).
+	 *
+	 * @tparam Str A hybstr::string_impl or hybstr::concat_expr instance.
+	 */
+	template<auto Str>
+	[[nodiscard]] constexpr auto compressed() noexcept -> compressed_string<Str>
+	{
+		return {};
+	}
+#endif
+
+	// ======================================================================
+	//                           Formatting
+	// ======================================================================
+
+	namespace detail
+	{
+		/// @brief "00" to "99", so integers are written two digits at a time.
+		inline constexpr char digit_pairs[201] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+		/// @brief Maximum number of characters written by write_integer for @p T.
+		template<typename T>
+		inline constexpr std::size_t integer_capacity_v = static_cast<std::size_t>(std::numeric_limits<T>::digits10) + 1 + std::is_signed_v<T>;
+
+		/// @brief Maximum number of characters of the shortest round-trip representation of @p T.
+		template<typename T>
+		inline constexpr std::size_t floating_capacity_v =
+			static_cast<std::size_t>(std::numeric_limits<T>::max_digits10) + 4 // sign, '.', 'e', exponent sign
+			+ (std::numeric_limits<T>::max_exponent10 >= 1000 ? 4 : std::numeric_limits<T>::max_exponent10 >= 100 ? 3 : 2);
+
+		/// @brief True for the integer types formatted as numbers (not bool or char).
+		template<typename T>
+		inline constexpr bool is_format_integer_v = std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>;
+
+		template<typename U>
+		constexpr auto count_digits(U value) noexcept -> std::size_t
+		{
+			std::size_t n = 1;
+			for (;;)
+			{
+				if (value < 10) return n;
+				if (value < 100) return n + 1;
+				if (value < 1000) return n + 2;
+				if (value < 10000) return n + 3;
+				value /= 10000u;
+				n += 4;
+			}
+		}
+
+		/**
+		 * @brief Writes @p value in decimal at @p out, which must have room for integer_capacity_v<T> characters.
+		 * @return Number of characters written.
+		 */
+		template<typename T>
+		constexpr auto write_integer(char* out, T value) noexcept -> std::size_t
+		{
+			using U = std::make_unsigned_t<T>;
+			U u = static_cast<U>(value);
+			std::size_t sign = 0;
+			if constexpr (std::is_signed_v<T>)
+			{
+				if (value < 0)
+				{
+					*out = '-';
+					sign = 1;
+					u = static_cast<U>(U{ 0 } - u);
+				}
+			}
+			const std::size_t digits = count_digits(u);
+			char* p = out + sign + digits;
+			while (u >= 100)
+			{
+				const auto i = static_cast<std::size_t>(u % 100u) * 2;
+				u = static_cast<U>(u / 100u);
+				*--p = digit_pairs[i + 1];
+				*--p = digit_pairs[i];
+			}
+			if (u >= 10)
+			{
+				const auto i = static_cast<std::size_t>(u) * 2;
+				*--p = digit_pairs[i + 1];
+				*--p = digit_pairs[i];
+			}
+			else
+			{
+				*--p = static_cast<char>('0' + u);
+			}
+			return sign + digits;
+		}
+
+		/**
+		 * @brief How a format argument of type @p T is sized and written.
+		 *
+		 * @details
+		 * 'capacity' is the worst-case number of characters known from the type, 'dynamic' is 1 for
+		 * runtime sized strings (which reserve the DynamicExpandCapacity of the result, like concatenation).
+		 */
+		template<typename T, typename = void>
+		struct format_arg
+		{
+			static_assert(!std::is_same_v<T, T>, "Unsupported hybstr::format argument type");
+		};
+		template<>
+		struct format_arg<bool>
+		{
+			static constexpr std::size_t capacity = 5;
+			static constexpr std::size_t dynamic = 0;
+
+			template<typename Out>
+			static constexpr void append(Out& out, bool value) noexcept(noexcept(out.append_inplace(std::string_view())))
+			{
+				out.append_inplace(value ? std::string_view("true") : std::string_view("false"));
+			}
+		};
+		template<>
+		struct format_arg<char>
+		{
+			static constexpr std::size_t capacity = 1;
+			static constexpr std::size_t dynamic = 0;
+
+			template<typename Out>
+			static constexpr void append(Out& out, char value) noexcept(noexcept(out.append_inplace(std::string_view())))
+			{
+				out.append_inplace(1, value);
+			}
+		};
+		template<typename T>
+		struct format_arg<T, std::enable_if_t<is_format_integer_v<T>>>
+		{
+			static constexpr std::size_t capacity = integer_capacity_v<T>;
+			static constexpr std::size_t dynamic = 0;
+
+			template<typename Out>
+			static constexpr void append(Out& out, T value) noexcept(noexcept(out.append_inplace(std::string_view())))
+			{
+				std::array<char, capacity> buffer{};
+				out.append_inplace(std::string_view(buffer.data(), write_integer(buffer.data(), value)));
+			}
+		};
+		template<typename T>
+		struct format_arg<T, std::enable_if_t<std::is_floating_point_v<T>>>
+		{
+			static constexpr std::size_t capacity = floating_capacity_v<T>;
+			static constexpr std::size_t dynamic = 0;
+
+			/** @brief Shortest round-trip representation. Runtime only. */
+			template<typename Out>
+			static void append(Out& out, T value) noexcept(noexcept(out.append_inplace(std::string_view())))
+			{
+				std::array<char, capacity> buffer;
+				const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+				out.append_inplace(std::string_view(buffer.data(), static_cast<std::size_t>(result.ptr - buffer.data())));
+			}
+		};
+		template<std::size_t N>
+		struct format_arg<char[N]>
+		{
+			static constexpr std::size_t capacity = N - 1;
+			static constexpr std::size_t dynamic = 0;
+
+			template<typename Out>
+			static constexpr void append(Out& out, const char(&value)[N]) noexcept(noexcept(out.append_inplace(std::string_view())))
+			{
+				out.append_inplace(std::string_view(value, N - 1));
+			}
+		};
+		template<std::size_t B, std::size_t D, typename P>
+		struct format_arg<string_impl<B, D, P>>
+		{
+			static constexpr std::size_t capacity = B;
+			static constexpr std::size_t dynamic = 0;
+
+			template<typename Out>
+			static constexpr void append(Out& out, const string_impl<B, D, P>& value) noexcept(noexcept(out.append_inplace(std::string_view())))
+			{
+				out.append_inplace(value.view());
+			}
+		};
+		template<typename T>
+		struct format_arg<T, std::enable_if_t<!std::is_array_v<T> && std::is_convertible_v<const T&, std::string_view>>>
+		{
+			static constexpr std::size_t capacity = 0;
+			static constexpr std::size_t dynamic = 1;
+
+			template<typename Out>
+			static constexpr void append(Out& out, const T& value) noexcept(noexcept(out.append_inplace(std::string_view())))
+			{
+				out.append_inplace(std::string_view(value));
+			}
+		};
+	} // namespace detail
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	namespace detail
+	{
+		/// @brief A piece of a parsed format string: literal text, or the argument at index 'arg'.
+		struct format_segment
+		{
+			std::size_t begin = 0;
+			std::size_t length = 0;
+			std::size_t arg = npos; ///< npos for literal text.
+		};
+
+		/**
+		 * @brief Splits @p fmt into segments, written to @p out unless it is null.
+		 *
+		 * @details
+		 * Supports '{}', '{N}' and the '{{' / '}}' escapes. Format specs are rejected.
+		 * @return Number of segments.
+		 */
+		consteval auto parse_format(std::string_view fmt, format_segment* out) -> std::size_t
+		{
+			std::size_t count = 0;
+			std::size_t next_arg = 0;
+			std::size_t text_begin = 0;
+			bool automatic = false;
+			bool manual = false;
+			const auto emit = [&](format_segment segment)
+				{
+					if (segment.arg != npos || segment.length != 0)
+					{
+						if (out)
+						{
+							out[count] = segment;
+						}
+						++count;
+					}
+				};
+
+			for (std::size_t i = 0; i < fmt.size(); ++i)
+			{
+				if (fmt[i] != '{' && fmt[i] != '}')
+				{
+					continue;
+				}
+				if (i + 1 < fmt.size() && fmt[i + 1] == fmt[i])
+				{
+					emit({ text_begin, i + 1 - text_begin });
+					text_begin = ++i + 1;
+					continue;
+				}
+				if (fmt[i] == '}')
+				{
+					throw "hybstr::format: unmatched '}'";
+				}
+
+				emit({ text_begin, i - text_begin });
+				std::size_t j = i + 1;
+				std::size_t index = 0;
+				for (; j < fmt.size() && fmt[j] >= '0' && fmt[j] <= '9'; ++j)
+				{
+					index = index * 10 + static_cast<std::size_t>(fmt[j] - '0');
+				}
+				if (j == fmt.size() || fmt[j] != '}')
+				{
+					throw "hybstr::format: expected '}' (format specs are not supported)";
+				}
+				if (j == i + 1)
+				{
+					automatic = true;
+					index = next_arg++;
+				}
+				else
+				{
+					manual = true;
+				}
+				if (automatic && manual)
+				{
+					throw "hybstr::format: cannot mix automatic and manual argument indexing";
+				}
+				emit({ 0, 0, index });
+				i = j;
+				text_begin = j + 1;
+			}
+			emit({ text_begin, fmt.size() - text_begin });
+			return count;
+		}
+
+		template<std::size_t Count>
+		consteval auto make_format_segments(std::string_view fmt) -> std::array<format_segment, Count>
+		{
+			std::array<format_segment, Count> segments{};
+			parse_format(fmt, segments.data());
+			return segments;
+		}
+
+		/** @brief Format string @p Fmt, parsed once per distinct string. */
+		template<auto Fmt>
+		struct parsed_format
+		{
+			static constexpr std::string_view text = Fmt.view();
+			static constexpr std::size_t count = parse_format(text, nullptr);
+			static constexpr std::array<format_segment, count> segments = make_format_segments<count>(text);
+
+			/** @return Number of arguments the format string refers to. */
+			static consteval auto arguments() noexcept -> std::size_t
+			{
+				std::size_t n = 0;
+				for (const format_segment& segment : segments)
+				{
+					if (segment.arg != npos)
+					{
+						n = std::max(n, segment.arg + 1);
+					}
+				}
+				return n;
+			}
+
+			/** @return Worst-case length of the output for arguments of types @p Args. */
+			template<std::size_t DynamicExpandCapacity, typename... Args>
+			static consteval auto capacity() noexcept -> std::size_t
+			{
+				constexpr std::array<std::size_t, sizeof...(Args) + 1> arg_capacity{
+					(format_arg<Args>::capacity + format_arg<Args>::dynamic * DynamicExpandCapacity)..., 0 };
+				std::size_t n = 0;
+				for (const format_segment& segment : segments)
+				{
+					n += segment.arg == npos ? segment.length : arg_capacity[segment.arg];
+				}
+				return n;
+			}
+		};
+
+		template<typename Parsed, std::size_t I, typename Out, typename... Args>
+		constexpr void format_piece(Out& out, const std::tuple<const Args&...>& args) noexcept(noexcept(out.append_inplace(std::string_view())))
+		{
+			constexpr format_segment segment = Parsed::segments[I];
+			if constexpr (segment.arg == npos)
+			{
+				out.append_inplace(Parsed::text.substr(segment.begin, segment.length));
+			}
+			else
+			{
+				using arg_type = std::remove_cvref_t<std::tuple_element_t<segment.arg, std::tuple<Args...>>>;
+				format_arg<arg_type>::append(out, std::get<segment.arg>(args));
+			}
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Formats @p args into a single string_impl, with the format string parsed at compile time. C++20 or above.
+	 *
+	 * @details
+	 * The format string supports '{}', '{N}' and the '{{' / '}}' escapes. The capacity of the result
+	 * is the worst case for the argument types: exact limits for numbers, bool and char, the capacity of
+	 * string_impl and literal arguments, and @p DynamicExpandCapacity for runtime strings
+	 * ('std::string_view', 'std::string', 'const char*'). At runtime only the argument conversions
+	 * and the copies remain. Floating-point arguments are formatted at runtime only.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * static_assert(hybstr::format<"{} + {} = {}"_hyb>(1, 2, 3).view() == "1 + 2 = 3");
+	 * auto line = hybstr::format<"{}: {} ms"_hyb>(route, elapsed_ms);
+	 * @endcode
+	 *
+	 * @tparam Fmt Format string, a hybstr::string_impl instance.
+	 * @tparam DynamicExpandCapacity Characters reserved for each runtime-sized string argument.
+	 * @tparam Policy Policy of the result.
+	 */
+	template<auto Fmt, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, typename Policy = default_policy, typename... Args>
+	[[nodiscard]] constexpr auto format(const Args&... args) noexcept(detail::overflow_nothrow_v<Policy>)
+	{
+		static_assert(is_string_impl_v<std::remove_cvref_t<decltype(Fmt)>>, "Expect a hybstr::string_impl format string");
+
+		using parsed = detail::parsed_format<Fmt>;
+		static_assert(parsed::arguments() <= sizeof...(Args), "hybstr::format: not enough arguments for the format string");
+
+		constexpr std::size_t capacity = parsed::template capacity<DynamicExpandCapacity, std::remove_cvref_t<Args>...>();
+		string_impl<detail::policy_capacity_v<Policy, capacity>, DynamicExpandCapacity, Policy> result;
+		const std::tuple<const Args&...> refs(args...);
+		[&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			(detail::format_piece<parsed, I>(result, refs), ...);
+		}(std::make_index_sequence<parsed::count>{});
+		return result;
+	}
+#endif
+
+	// ======================================================================
+	//                           Concatenation and Joining
+	// ======================================================================
+
+	namespace detail
+	{
+		/// @brief Upper bound on the characters format_arg<T> writes for @p value (exact for strings).
+		template<typename T>
+		constexpr auto format_arg_size(const T& value) noexcept -> std::size_t
+		{
+			if constexpr (is_string_impl_v<T>)
+			{
+				return value.size();
+			}
+			else if constexpr (format_arg<T>::dynamic != 0)
+			{
+				return std::string_view(value).size();
+			}
+			else
+			{
+				return format_arg<T>::capacity;
+			}
+		}
+
+		/// @brief Capacity of a concatenation of @p Parts: exact for fixed-size parts, DynamicExpandCapacity for runtime strings.
+		template<std::size_t DynamicExpandCapacity, typename... Parts>
+		inline constexpr std::size_t concat_capacity_v =
+			((format_arg<Parts>::capacity + format_arg<Parts>::dynamic * DynamicExpandCapacity) + ... + 0);
+	} // namespace detail
+
+	/**
+	 * @brief Concatenates @p parts into a single string_impl in one pass.
+	 *
+	 * @details
+	 * Accepts any mix of string_impl, literals, 'char', runtime strings ('std::string_view', 'std::string',
+	 * 'const char*') and the other hybstr::format argument types. The capacity of the result is computed
+	 * at compile time like format's; with spill_storage the runtime size is measured and reserved first.
+	 * Unlike a chain of 'operator+', no operand needs to be a hybstr string.
+	 * @code
+	 * constexpr auto key = hybstr::concat("metric", '.', hybstr::string("cpu"));   // string_impl<10>
+	 * auto label = hybstr::concat<64>(name, "=", value);
+	 * @endcode
+	 *
+	 * @tparam DynamicExpandCapacity Characters reserved for each runtime-sized string part.
+	 * @tparam Policy Policy of the result.
+	 */
+	template<std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, typename Policy = default_policy, typename... Parts>
+	[[nodiscard]] constexpr auto concat(const Parts&... parts) noexcept(detail::overflow_nothrow_v<Policy>)
+	{
+		constexpr std::size_t capacity = detail::concat_capacity_v<DynamicExpandCapacity, Parts...>;
+		string_impl<detail::policy_capacity_v<Policy, capacity>, DynamicExpandCapacity, Policy> result;
+		if constexpr (detail::policy_spills_v<Policy>)
+		{
+			result.reserve_inplace((detail::format_arg_size(parts) + ... + 0));
+		}
+		(detail::format_arg<Parts>::append(result, parts), ...);
+		return result;
+	}
+
+	/**
+	 * @brief Joins the elements of a runtime @p range with @p separator.
+	 *
+	 * @details
+	 * Elements and the separator may be of any hybstr::format argument type. The result has
+	 * @p DynamicExpandCapacity characters; use a spill policy for unbounded input, in which case the
+	 * total size is measured first and reserved once. Overflow is handled by the policy.
+	 * @code
+	 * std::vector<std::string> labels = ...;
+	 * auto line = hybstr::join<256>(labels, ',');
+	 * auto all = hybstr::join<64, hybstr::spill_policy>(labels, ", ");
+	 * @endcode
+	 *
+	 * @tparam DynamicExpandCapacity Capacity of the result.
+	 * @tparam Policy Policy of the result.
+	 */
+	template<std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, typename Policy = default_policy, typename Range, typename Separator>
+	[[nodiscard]] constexpr auto join(const Range& range, const Separator& separator) noexcept(detail::overflow_nothrow_v<Policy>)
+	{
+		using element_type = detail::remove_cvref_t<decltype(*std::begin(range))>;
+
+		string_impl<detail::policy_capacity_v<Policy, DynamicExpandCapacity>, DynamicExpandCapacity, Policy> result;
+		if constexpr (detail::policy_spills_v<Policy>)
+		{
+			std::size_t total = 0;
+			std::size_t count = 0;
+			for (const auto& element : range)
+			{
+				total += detail::format_arg_size(element);
+				++count;
+			}
+			if (count != 0)
+			{
+				result.reserve_inplace(total + (count - 1) * detail::format_arg_size(separator));
+			}
+		}
+
+		bool first = true;
+		for (const auto& element : range)
+		{
+			if (!first)
+			{
+				detail::format_arg<Separator>::append(result, separator);
+			}
+			first = false;
+			detail::format_arg<element_type>::append(result, element);
+		}
+		return result;
+	}
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/**
+	 * @brief Concatenates @p parts with the compile-time separator @p Sep in between. C++20 or above.
+	 *
+	 * @details
+	 * The capacity is that of concat(parts...) plus the separators.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * static_assert(hybstr::join<", "_hyb>("a", 'b', hybstr::string("c")).view() == "a, b, c");
+	 * @endcode
+	 *
+	 * @tparam Sep Separator, a hybstr::string_impl instance.
+	 * @tparam DynamicExpandCapacity Characters reserved for each runtime-sized string part.
+	 * @tparam Policy Policy of the result.
+	 */
+	template<auto Sep, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, typename Policy = default_policy, typename... Parts>
+		requires is_string_impl_v<std::remove_cvref_t<decltype(Sep)>>
+	[[nodiscard]] constexpr auto join(const Parts&... parts) noexcept(detail::overflow_nothrow_v<Policy>)
+	{
+		constexpr std::string_view separator = Sep.view();
+		constexpr std::size_t separators = sizeof...(Parts) == 0 ? 0 : sizeof...(Parts) - 1;
+		constexpr std::size_t capacity = detail::concat_capacity_v<DynamicExpandCapacity, Parts...> + separators * separator.size();
+
+		string_impl<detail::policy_capacity_v<Policy, capacity>, DynamicExpandCapacity, Policy> result;
+		if constexpr (detail::policy_spills_v<Policy>)
+		{
+			result.reserve_inplace((detail::format_arg_size(parts) + ... + 0) + separators * separator.size());
+		}
+
+		[[maybe_unused]] std::size_t index = 0;
+		([&]
+		{
+			if (index++ != 0)
+			{
+				result.append_inplace(separator);
+			}
+			detail::format_arg<Parts>::append(result, parts);
+		}(), ...);
+		return result;
+	}
+#endif
+
+	// ======================================================================
+	//                           Builder
+	// ======================================================================
+
+	/**
+	 * @brief Mutable string of fixed capacity for runtime code that appends repeatedly.
+	 *
+	 * @details
+	 * Accepts every hybstr::format argument type: 'char', literals, runtime strings, numbers, bool and
+	 * string_impl, written in place without intermediate copies. What happens when the buffer is full is
+	 * chosen by @p Policy: 'truncate_overflow' keeps what fits, 'throw_overflow' throws and leaves the
+	 * builder unchanged, 'assert_overflow' (the default) asserts, and spill_storage moves the contents to
+	 * the heap at runtime. Whenever input is cut short, 'truncated()' reports it until the next 'clear()'.
+	 * The result is read with 'view()' or moved out with 'take()'.
+	 * @code
+	 * hybstr::builder<512, hybstr::with_overflow<hybstr::truncate_overflow>> frame;
+	 * frame << "PUB " << subject << ' ' << payload.size() << "\r\n" << payload << "\r\n";
+	 * if (frame.truncated()) { ... }
+	 * ::send(fd, frame.data(), frame.size(), 0);
+	 * frame.clear();
+	 * @endcode
+	 *
+	 * @tparam Capacity Characters in the fixed buffer.
+	 * @tparam Policy Policy of the underlying string_impl.
+	 */
+	template<std::size_t Capacity, typename Policy = default_policy>
+	class builder
+	{
+	public:
+		using string_type = string_impl<Capacity, HYBSTR_DYNAMIC_EXPAND_CAPACITY, Policy>;
+		using size_type = std::size_t;
+
+		constexpr builder() noexcept = default;
+
+		/** @brief Appends @p value, of any hybstr::format argument type. @return *this */
+		template<typename T>
+		constexpr auto append(const T& value) noexcept(detail::overflow_nothrow_v<Policy>) -> builder&
+		{
+			detail::format_arg<T>::append(*this, value);
+			return *this;
+		}
+		/** @brief Appends @p n copies of @p c. @return *this */
+		constexpr auto append(size_type n, char c) noexcept(detail::overflow_nothrow_v<Policy>) -> builder&
+		{
+			return append_inplace(n, c);
+		}
+		/** @brief Appends a single character. @return *this */
+		constexpr auto push_back(char c) noexcept(detail::overflow_nothrow_v<Policy>) -> builder&
+		{
+			return append_inplace(1, c);
+		}
+		/** @brief Same as append(value). */
+		template<typename T>
+		constexpr auto operator<<(const T& value) noexcept(detail::overflow_nothrow_v<Policy>) -> builder&
+		{
+			return append(value);
+		}
+		/** @brief Same as append(value). */
+		template<typename T>
+		constexpr auto operator+=(const T& value) noexcept(detail::overflow_nothrow_v<Policy>) -> builder&
+		{
+			return append(value);
+		}
+
+		/** @brief Appends the characters of @p sv. Used by the format_arg writers. @return *this */
+		constexpr auto append_inplace(std::string_view sv) noexcept(detail::overflow_nothrow_v<Policy>) -> builder&
+		{
+			_check(sv.size());
+			_str.append_inplace(sv);
+			return *this;
+		}
+		/** @brief Appends @p n copies of @p c. Used by the format_arg writers. @return *this */
+		constexpr auto append_inplace(size_type n, char c) noexcept(detail::overflow_nothrow_v<Policy>) -> builder&
+		{
+			_check(n);
+			_str.append_inplace(n, c);
+			return *this;
+		}
+
+		/** @brief Removes all characters and resets the truncation flag. */
+		constexpr void clear() noexcept
+		{
+			_str.clear();
+			_truncated = false;
+		}
+
+		/** @return True if some input did not fit since construction or the last clear(). */
+		[[nodiscard]] constexpr auto truncated() const noexcept -> bool
+		{
+			return _truncated;
+		}
+		/** @return Number of characters written. */
+		[[nodiscard]] constexpr auto size() const noexcept -> size_type
+		{
+			return _str.size();
+		}
+		/** @return True if nothing has been written. */
+		[[nodiscard]] constexpr auto empty() const noexcept -> bool
+		{
+			return _str.empty();
+		}
+		/** @return Characters in the fixed buffer. */
+		[[nodiscard]] constexpr auto capacity() const noexcept -> size_type
+		{
+			return Capacity;
+		}
+		/** @return Characters that still fit in the fixed buffer. */
+		[[nodiscard]] constexpr auto remaining() const noexcept -> size_type
+		{
+			return _str.size() < Capacity ? Capacity - _str.size() : 0;
+		}
+		/** @return Pointer to the characters (null-terminated). */
+		[[nodiscard]] constexpr auto data() const noexcept -> const char*
+		{
+			return _str.data();
+		}
+		/** @return Null-terminated C string. */
+		[[nodiscard]] constexpr auto c_str() const noexcept -> const char*
+		{
+			return _str.c_str();
+		}
+		/** @return View of the contents, valid until the next modification. */
+		[[nodiscard]] constexpr auto view() const noexcept -> std::string_view
+		{
+			return _str.view();
+		}
+		/** @return The contents written so far. */
+		[[nodiscard]] constexpr auto get() const noexcept -> const string_type&
+		{
+			return _str;
+		}
+		/** @brief Moves the contents out and leaves the builder empty. */
+		[[nodiscard]] constexpr auto take() noexcept -> string_type
+		{
+			string_type result(std::move(_str));
+			clear();
+			return result;
+		}
+
+	private:
+		/** @brief Records whether @p n more characters will be cut short. */
+		constexpr void _check(size_type n) noexcept
+		{
+			if constexpr (!detail::overflow_nothrow_v<Policy>)
+			{
+				// The append throws instead and leaves the builder unchanged: nothing is cut.
+				return;
+			}
+			else if constexpr (detail::policy_spills_v<Policy>)
+			{
+				if (!HYBSTR_IS_CONSTANT_EVALUATED)
+				{
+					return;
+				}
+			}
+			_truncated = _truncated || n > remaining();
+		}
+
+		string_type _str;
+		bool _truncated = false;
+	};
+
+	// ======================================================================
+	//                           Arena
+	// ======================================================================
+
+	class arena;
+
+	/**
+	 * @brief Handle to a null-terminated string stored in a hybstr::arena.
+	 *
+	 * @details
+	 * Two words (pointer and size), trivially copyable, and read-only like a 'std::string_view', with the
+	 * string_impl observers, searches and comparisons. It stays valid until the arena is released or reset.
+	 * Appending goes through the arena and returns a new handle. It extends the string in place when it is
+	 * the last allocation in the arena. A default-constructed handle is the empty string.
+	 */
+	class arena_string
+	{
+	public:
+		using value_type = char;
+		using size_type = std::size_t;
+		using const_iterator = const char*;
+
+		/// @brief "Not found" position returned by the search operations.
+		static constexpr size_type npos = detail::npos;
+
+		constexpr arena_string() noexcept = default;
+
+		/** @return Number of characters. */
+		[[nodiscard]] constexpr auto size() const noexcept -> size_type
+		{
+			return _size;
+		}
+		/** @return True if the string is empty. */
+		[[nodiscard]] constexpr auto empty() const noexcept -> bool
+		{
+			return _size == 0;
+		}
+		/** @return Pointer to the characters (null-terminated). */
+		[[nodiscard]] constexpr auto data() const noexcept -> const char*
+		{
+			return _data;
+		}
+		/** @return Null-terminated C string. */
+		[[nodiscard]] constexpr auto c_str() const noexcept -> const char*
+		{
+			return _data;
+		}
+		/** @return View of the characters. */
+		[[nodiscard]] constexpr auto view() const noexcept -> std::string_view
+		{
+			return std::string_view(_data, _size);
+		}
+		[[nodiscard]] constexpr operator std::string_view() const noexcept
+		{
+			return view();
+		}
+		/** @return A std::string copy (runtime). */
+		[[nodiscard]] auto str() const -> std::string
+		{
+			return std::string(_data, _size);
+		}
+		[[nodiscard]] constexpr auto operator[](size_type i) const noexcept -> char
+		{
+			return _data[i];
+		}
+		[[nodiscard]] constexpr auto begin() const noexcept -> const_iterator
+		{
+			return _data;
+		}
+		[[nodiscard]] constexpr auto end() const noexcept -> const_iterator
+		{
+			return _data + _size;
+		}
+
+		/** @return Position of the first occurrence of @p needle at or after @p pos, or npos. */
+		[[nodiscard]] constexpr auto find(std::string_view needle, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_chars(_data, _size, needle.data(), needle.size(), pos);
+		}
+		/** @return Position of the first @p c at or after @p pos, or npos. */
+		[[nodiscard]] constexpr auto find(char c, size_type pos = 0) const noexcept -> size_type
+		{
+			return detail::find_char(_data, _size, c, pos);
+		}
+		/** @return True if @p needle occurs in the string. */
+		[[nodiscard]] constexpr auto contains(std::string_view needle) const noexcept -> bool
+		{
+			return find(needle) != npos;
+		}
+		/** @return True if the string begins with @p prefix. */
+		[[nodiscard]] constexpr auto starts_with(std::string_view prefix) const noexcept -> bool
+		{
+			return prefix.size() <= _size && detail::equal_chars(_data, prefix.data(), prefix.size());
+		}
+		/** @return True if the string ends with @p suffix. */
+		[[nodiscard]] constexpr auto ends_with(std::string_view suffix) const noexcept -> bool
+		{
+			return suffix.size() <= _size && detail::equal_chars(_data + (_size - suffix.size()), suffix.data(), suffix.size());
+		}
+
+		/** @brief Same as 'a.append(*this, tail)'. */
+		auto append(arena& a, std::string_view tail) const noexcept -> arena_string;
+
+#if HYBSTR_CPP_20_OR_ABOVE
+		[[nodiscard]] friend constexpr auto operator==(const arena_string& lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs.view() == rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator==(const arena_string& lhs, std::string_view rhs) noexcept -> bool
+		{
+			return lhs.view() == rhs;
+		}
+		[[nodiscard]] friend constexpr auto operator<=>(const arena_string& lhs, const arena_string& rhs) noexcept
+		{
+			return lhs.view() <=> rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator<=>(const arena_string& lhs, std::string_view rhs) noexcept
+		{
+			return lhs.view() <=> rhs;
+		}
+#else
+		[[nodiscard]] friend constexpr auto operator==(const arena_string& lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs.view() == rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator==(const arena_string& lhs, std::string_view rhs) noexcept -> bool
+		{
+			return lhs.view() == rhs;
+		}
+		[[nodiscard]] friend constexpr auto operator==(std::string_view lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs == rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator!=(const arena_string& lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs.view() != rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator!=(const arena_string& lhs, std::string_view rhs) noexcept -> bool
+		{
+			return lhs.view() != rhs;
+		}
+		[[nodiscard]] friend constexpr auto operator!=(std::string_view lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs != rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator<(const arena_string& lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs.view() < rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator<(const arena_string& lhs, std::string_view rhs) noexcept -> bool
+		{
+			return lhs.view() < rhs;
+		}
+		[[nodiscard]] friend constexpr auto operator<(std::string_view lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs < rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator<=(const arena_string& lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs.view() <= rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator<=(const arena_string& lhs, std::string_view rhs) noexcept -> bool
+		{
+			return lhs.view() <= rhs;
+		}
+		[[nodiscard]] friend constexpr auto operator<=(std::string_view lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs <= rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator>(const arena_string& lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs.view() > rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator>(const arena_string& lhs, std::string_view rhs) noexcept -> bool
+		{
+			return lhs.view() > rhs;
+		}
+		[[nodiscard]] friend constexpr auto operator>(std::string_view lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs > rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator>=(const arena_string& lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs.view() >= rhs.view();
+		}
+		[[nodiscard]] friend constexpr auto operator>=(const arena_string& lhs, std::string_view rhs) noexcept -> bool
+		{
+			return lhs.view() >= rhs;
+		}
+		[[nodiscard]] friend constexpr auto operator>=(std::string_view lhs, const arena_string& rhs) noexcept -> bool
+		{
+			return lhs >= rhs.view();
+		}
+#endif
+
+	private:
+		friend class arena;
+
+		constexpr arena_string(const char* data, size_type size) noexcept
+			: _data(data), _size(size)
+		{
+		}
+
+		const char* _data = "";
+		size_type _size = 0;
+	};
+
+	/**
+	 * @brief Monotonic allocator for runtime strings, released in bulk.
+	 *
+	 * @details
+	 * Characters are bump-allocated from blocks of 'block_size' bytes, so consecutive strings are
+	 * contiguous in memory. Blocks are only freed all at once by 'release()', or by 'reset()', which
+	 * keeps the most recent block for the next batch. Strings longer than a block get a block of their
+	 * own. Runtime only. Allocation failure terminates, as with spill_storage. Not thread-safe.
+	 * @code
+	 * hybstr::arena batch;
+	 * std::vector<hybstr::arena_string> keys;
+	 * for (std::string_view row : rows)
+	 * {
+	 *     keys.push_back(batch.make(column(row, 0)));
+	 * }
+	 * ...
+	 * batch.reset();   // drops every key at once, keeps one block for the next batch
+	 * @endcode
+	 */
+	class arena
+	{
+	public:
+		using size_type = std::size_t;
+
+		/// @brief Default block size in bytes.
+		static constexpr size_type default_block_size = 64 * 1024;
+
+		/** @param block_size Usable bytes per block. */
+		explicit arena(size_type block_size = default_block_size) noexcept
+			: _block_size(block_size == 0 ? 1 : block_size)
+		{
+		}
+		arena(const arena&) = delete;
+		auto operator=(const arena&) -> arena& = delete;
+		arena(arena&& other) noexcept
+			: _block_size(other._block_size), _head(other._head), _cursor(other._cursor), _limit(other._limit),
+			  _used(other._used), _reserved(other._reserved), _blocks(other._blocks)
+		{
+			other._forget();
+		}
+		auto operator=(arena&& other) noexcept -> arena&
+		{
+			if (this != &other)
+			{
+				release();
+				_block_size = other._block_size;
+				_head = other._head;
+				_cursor = other._cursor;
+				_limit = other._limit;
+				_used = other._used;
+				_reserved = other._reserved;
+				_blocks = other._blocks;
+				other._forget();
+			}
+			return *this;
+		}
+		~arena()
+		{
+			release();
+		}
+
+		/** @return Uninitialized storage for @p n characters, valid until release() or reset(). */
+		[[nodiscard]] auto allocate(size_type n) noexcept -> char*
+		{
+			if (n > _block_size)
+			{
+				return _add_block(n, false);
+			}
+			if (static_cast<size_type>(_limit - _cursor) < n)
+			{
+				_cursor = _add_block(_block_size, true);
+				_limit = _cursor + _block_size;
+			}
+			char* out = _cursor;
+			_cursor += n;
+			_used += n;
+			return out;
+		}
+
+		/** @brief Copies @p sv into the arena. */
+		[[nodiscard]] auto make(std::string_view sv) noexcept -> arena_string
+		{
+			char* out = allocate(sv.size() + 1);
+			detail::copy_chars(out, sv.data(), sv.size());
+			out[sv.size()] = '\0';
+			return arena_string(out, sv.size());
+		}
+		/** @brief Copies the contents of @p str into the arena. */
+		template<std::size_t B, std::size_t D, typename P>
+		[[nodiscard]] auto make(const string_impl<B, D, P>& str) noexcept -> arena_string
+		{
+			return make(str.view());
+		}
+		/** @brief Writes every operand of @p expr into the arena, without materializing it first. */
+		template<typename L, typename R>
+		[[nodiscard]] auto make(const concat_expr<L, R>& expr) noexcept -> arena_string
+		{
+			const size_type n = expr.size();
+			char* out = allocate(n + 1);
+			size_type len = 0;
+			expr.for_each_piece([out, &len](std::string_view piece) noexcept
+			{
+				detail::copy_chars(out + len, piece.data(), piece.size());
+				len += piece.size();
+			});
+			out[n] = '\0';
+			return arena_string(out, n);
+		}
+
+		/**
+		 * @brief Returns @p str followed by @p tail.
+		 * Grows @p str in place when it is the last allocation and the block has room, else copies both.
+		 */
+		[[nodiscard]] auto append(arena_string str, std::string_view tail) noexcept -> arena_string
+		{
+			char* end = const_cast<char*>(str.data()) + str.size();
+			if (end + 1 == _cursor && static_cast<size_type>(_limit - _cursor) >= tail.size())
+			{
+				detail::move_chars(end, tail.data(), tail.size());
+				end[tail.size()] = '\0';
+				_cursor += tail.size();
+				_used += tail.size();
+				return arena_string(str.data(), str.size() + tail.size());
+			}
+
+			const size_type n = str.size() + tail.size();
+			char* out = allocate(n + 1);
+			detail::copy_chars(out, str.data(), str.size());
+			detail::copy_chars(out + str.size(), tail.data(), tail.size());
+			out[n] = '\0';
+			return arena_string(out, n);
+		}
+
+		/** @brief Frees every block. All handles become invalid. */
+		void release() noexcept
+		{
+			while (_head)
+			{
+				char* previous = _header(_head).previous;
+				delete[] _head;
+				_head = previous;
+			}
+			_forget();
+		}
+		/** @brief Invalidates all handles but keeps the most recent block for reuse. */
+		void reset() noexcept
+		{
+			if (!_head)
+			{
+				return;
+			}
+			block_header header = _header(_head);
+			char* keep = _head;
+			_head = header.previous;
+			release();
+			header.previous = nullptr;
+			std::memcpy(keep, &header, sizeof(header));
+			_head = keep;
+			_cursor = keep + sizeof(block_header);
+			_limit = _cursor + header.size;
+			_reserved = header.size;
+			_blocks = 1;
+		}
+
+		/** @return Bytes handed out since the last release() or reset(), terminators included. */
+		[[nodiscard]] auto bytes_used() const noexcept -> size_type
+		{
+			return _used;
+		}
+		/** @return Bytes held in blocks. */
+		[[nodiscard]] auto bytes_reserved() const noexcept -> size_type
+		{
+			return _reserved;
+		}
+		/** @return Number of blocks held. */
+		[[nodiscard]] auto block_count() const noexcept -> size_type
+		{
+			return _blocks;
+		}
+		/** @return Usable bytes per regular block. */
+		[[nodiscard]] auto block_size() const noexcept -> size_type
+		{
+			return _block_size;
+		}
+
+	private:
+		/// @brief Stored at the start of every block.
+		struct block_header
+		{
+			char* previous;
+			size_type size;
+		};
+
+		[[nodiscard]] static auto _header(const char* block) noexcept -> block_header
+		{
+			block_header header;
+			std::memcpy(&header, block, sizeof(header));
+			return header;
+		}
+
+		/**
+		 * @brief Allocates a block of @p size usable bytes and returns them.
+		 * @p current blocks become the head; oversized ones are linked behind it so the head keeps its free space.
+		 */
+		[[nodiscard]] auto _add_block(size_type size, bool current) noexcept -> char*
+		{
+			char* block = new char[sizeof(block_header) + size];
+			block_header header{ _head, size };
+			if (!current && _head)
+			{
+				block_header head = _header(_head);
+				header.previous = head.previous;
+				head.previous = block;
+				std::memcpy(_head, &head, sizeof(head));
+			}
+			else
+			{
+				_head = block;
+			}
+			std::memcpy(block, &header, sizeof(header));
+			_reserved += size;
+			++_blocks;
+			if (!current)
+			{
+				_used += size;
+			}
+			return block + sizeof(block_header);
+		}
+
+		void _forget() noexcept
+		{
+			_head = nullptr;
+			_cursor = nullptr;
+			_limit = nullptr;
+			_used = 0;
+			_reserved = 0;
+			_blocks = 0;
+		}
+
+		size_type _block_size;
+		char* _head = nullptr;   ///< Most recent regular block (or the only block).
+		char* _cursor = nullptr; ///< Next free byte in the head block.
+		char* _limit = nullptr;  ///< End of the head block.
+		size_type _used = 0;
+		size_type _reserved = 0;
+		size_type _blocks = 0;
+	};
+
+	inline auto arena_string::append(arena& a, std::string_view tail) const noexcept -> arena_string
+	{
+		return a.append(*this, tail);
+	}
+
+	// ======================================================================
+	//                           Intern Table
+	// ======================================================================
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	/**
+	 * @brief Thread-safe runtime interning: maps contents to a stable interned_ref. C++20 or above.
+	 *
+	 * @details
+	 * Two handles from the same table compare equal exactly when their contents are equal, so the
+	 * comparison is a single pointer comparison. The high bits of hash_bytes pick a shard.
+	 * Each shard is an open-addressing table of atomic slots:
+	 * - Lookups never lock. Inserting a new string locks only its shard.
+	 * - A shard that is half full is doubled and republished. The old slot arrays stay alive until
+	 *   the table is destroyed, so a reader still probing one sees an older but consistent snapshot.
+	 * - The characters are stored in a per-shard arena and never move.
+	 *
+	 * The hash is the constexpr hash_bytes. Compile-time strings can be seeded, and intern then returns
+	 * the same handle as hybstr::intern_ref:
+	 * @code
+	 * using namespace hybstr::literals;
+	 * hybstr::intern_table labels;
+	 * labels.seed<"cpu"_hyb, "mem"_hyb>();
+	 * assert(labels.intern(std::string("cpu")) == hybstr::intern_ref<"cpu"_hyb>());
+	 * @endcode
+	 */
+	class intern_table
+	{
+		struct slot
+		{
+			std::atomic<const std::string_view*> entry{ nullptr };
+			std::atomic<std::uint64_t> hash{ 0 };
+		};
+		struct generation
+		{
+			explicit generation(std::size_t capacity)
+				: mask(capacity - 1), slots(new slot[capacity])
+			{
+			}
+
+			std::size_t mask;
+			std::unique_ptr<slot[]> slots;
+		};
+		struct alignas(64) shard
+		{
+			std::atomic<const generation*> current{ nullptr };
+			std::atomic<std::size_t> count{ 0 };
+			std::mutex mutex;                                      ///< Guards everything below and insertion.
+			std::vector<std::unique_ptr<generation>> generations;  ///< Every slot array ever published, the current one last.
+			std::deque<std::string_view> views;                    ///< Interned entries; handles point here.
+			arena chars{ 4096 };
+		};
+	public:
+		using size_type = std::size_t;
+
+		/**
+		 * @param shards Number of shards, rounded up to a power of two. More shards means less contention on insertion.
+		 * @param shard_capacity Initial slots per shard, rounded up to a power of two.
+		 */
+		explicit intern_table(size_type shards = 64, size_type shard_capacity = 16)
+			: _shard_mask(detail::bit_ceil(shards) - 1), _shards(new shard[_shard_mask + 1])
+		{
+			const size_type capacity = detail::bit_ceil(std::max<size_type>(shard_capacity, 2));
+			for (size_type i = 0; i <= _shard_mask; ++i)
+			{
+				_shards[i].generations.push_back(std::make_unique<generation>(capacity));
+				_shards[i].current.store(_shards[i].generations.back().get(), std::memory_order_relaxed);
+			}
+			// The empty string maps to the default handle.
+			(void)insert(interned_ref{});
+		}
+		intern_table(const intern_table&) = delete;
+		auto operator=(const intern_table&) -> intern_table& = delete;
+
+		/** @return Handle for the contents of @p sv, which are copied into the table the first time they are seen. */
+		[[nodiscard]] auto intern(std::string_view sv) -> interned_ref
+		{
+			const std::uint64_t h = hash_bytes(sv);
+			shard& s = _shard_of(h);
+			if (const std::string_view* found = _probe(s.current.load(std::memory_order_acquire), sv, h))
+			{
+				return interned_ref(found);
+			}
+
+			std::lock_guard<std::mutex> lock(s.mutex);
+			if (const std::string_view* found = _probe(s.current.load(std::memory_order_relaxed), sv, h))
+			{
+				return interned_ref(found);
+			}
+			const arena_string chars = s.chars.make(sv);
+			const std::string_view* entry = &s.views.emplace_back(chars.data(), chars.size());
+			_insert(s, entry, h);
+			return interned_ref(entry);
+		}
+		/**
+		 * @brief Registers an existing handle, so that intern returns it for the same contents.
+		 * @return The handle stored for the contents: @p ref, or the one that was already there.
+		 */
+		auto insert(interned_ref ref) -> interned_ref
+		{
+			const std::string_view sv = ref.view();
+			const std::uint64_t h = hash_bytes(sv);
+			shard& s = _shard_of(h);
+			std::lock_guard<std::mutex> lock(s.mutex);
+			if (const std::string_view* found = _probe(s.current.load(std::memory_order_relaxed), sv, h))
+			{
+				return interned_ref(found);
+			}
+			_insert(s, ref._entry, h);
+			return ref;
+		}
+		/** @brief Registers the compile-time interned instances of @p Strs (see intern_ref). */
+		template<auto... Strs>
+		void seed()
+		{
+			((void)insert(intern_ref<Strs>()), ...);
+		}
+
+		/** @return Handle for @p sv if it has been interned, without inserting. Never locks. */
+		[[nodiscard]] auto find(std::string_view sv) const noexcept -> std::optional<interned_ref>
+		{
+			const std::uint64_t h = hash_bytes(sv);
+			if (const std::string_view* found = _probe(_shard_of(h).current.load(std::memory_order_acquire), sv, h))
+			{
+				return interned_ref(found);
+			}
+			return std::nullopt;
+		}
+		/** @return True if @p sv has been interned. Never locks. */
+		[[nodiscard]] auto contains(std::string_view sv) const noexcept -> bool
+		{
+			return find(sv).has_value();
+		}
+
+		/** @return Number of distinct strings, the empty string included. Exact once concurrent inserts have finished. */
+		[[nodiscard]] auto size() const noexcept -> size_type
+		{
+			size_type total = 0;
+			for (size_type i = 0; i <= _shard_mask; ++i)
+			{
+				total += _shards[i].count.load(std::memory_order_relaxed);
+			}
+			return total;
+		}
+		/** @return Number of shards. */
+		[[nodiscard]] auto shard_count() const noexcept -> size_type
+		{
+			return _shard_mask + 1;
+		}
+
+	private:
+		[[nodiscard]] auto _shard_of(std::uint64_t h) const noexcept -> shard&
+		{
+			// Slots use the low bits of the hash, shards the high ones.
+			return _shards[static_cast<size_type>(h >> 40) & _shard_mask];
+		}
+
+		/** @brief Entry equal to @p sv in @p g, or nullptr. */
+		[[nodiscard]] static auto _probe(const generation* g, std::string_view sv, std::uint64_t h) noexcept -> const std::string_view*
+		{
+			for (size_type i = static_cast<size_type>(h) & g->mask;; i = (i + 1) & g->mask)
+			{
+				const std::string_view* entry = g->slots[i].entry.load(std::memory_order_acquire);
+				if (!entry)
+				{
+					return nullptr;
+				}
+				if (g->slots[i].hash.load(std::memory_order_relaxed) == h && *entry == sv)
+				{
+					return entry;
+				}
+			}
+		}
+
+		/** @brief Writes @p entry to the first free slot of @p g. The hash is stored before the entry is published. */
+		static void _place(const generation& g, const std::string_view* entry, std::uint64_t h) noexcept
+		{
+			for (size_type i = static_cast<size_type>(h) & g.mask;; i = (i + 1) & g.mask)
+			{
+				if (!g.slots[i].entry.load(std::memory_order_relaxed))
+				{
+					g.slots[i].hash.store(h, std::memory_order_relaxed);
+					g.slots[i].entry.store(entry, std::memory_order_release);
+					return;
+				}
+			}
+		}
+
+		/** @brief Adds a new entry to @p s, doubling its slots first if they would be more than half full. Requires the shard lock. */
+		static void _insert(shard& s, const std::string_view* entry, std::uint64_t h)
+		{
+			const generation* g = s.current.load(std::memory_order_relaxed);
+			const size_type count = s.count.load(std::memory_order_relaxed);
+			if (2 * (count + 1) > g->mask + 1)
+			{
+				auto next = std::make_unique<generation>(2 * (g->mask + 1));
+				for (size_type i = 0; i <= g->mask; ++i)
+				{
+					if (const std::string_view* old = g->slots[i].entry.load(std::memory_order_relaxed))
+					{
+						_place(*next, old, g->slots[i].hash.load(std::memory_order_relaxed));
+					}
+				}
+				g = next.get();
+				s.generations.push_back(std::move(next));
+				s.current.store(g, std::memory_order_release);
+			}
+			_place(*g, entry, h);
+			s.count.store(count + 1, std::memory_order_relaxed);
+		}
+
+		size_type _shard_mask;
+		std::unique_ptr<shard[]> _shards;
+	};
+#endif
+
+	// ======================================================================
+	//                           String Table
+	// ======================================================================
+
+	/**
+	 * @brief Optional columns of a string_table, combined with '|'.
+	 */
+	enum class table_columns : unsigned
+	{
+		none = 0,
+		prefix = 1, ///< First 8 characters of each row as a big-endian integer, see prefix_key.
+		hash = 2,   ///< hash_bytes of each row.
+	};
+
+	/** @return Both sets of columns. */
+	[[nodiscard]] constexpr auto operator|(table_columns a, table_columns b) noexcept -> table_columns
+	{
+		return static_cast<table_columns>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+	}
+
+	namespace detail
+	{
+		/** @brief True if @p columns includes @p column. */
+		[[nodiscard]] constexpr auto has_column(table_columns columns, table_columns column) noexcept -> bool
+		{
+			return (static_cast<unsigned>(columns) & static_cast<unsigned>(column)) != 0;
+		}
+
+#if HYBSTR_HAS_PARALLEL
+		/// @brief SFINAE helper: valid only if @p T is a standard execution policy.
+		template<typename T>
+		using execution_policy_t = std::enable_if_t<std::is_execution_policy_v<remove_cvref_t<T>>>;
+#endif
+	} // namespace detail
+
+	/**
+	 * @brief Column store of strings of up to @p Capacity characters, for batch operations over many rows.
+	 *
+	 * @details
+	 * A 'std::vector<string_impl<N>>' interleaves every buffer with its size, so a scan that needs
+	 * only the sizes still reads every string. The table keeps separate columns instead:
+	 * - the characters in one contiguous slab. Row i starts at 'i * stride' and is zero-padded up to the stride.
+	 * - the sizes, in the smallest integer type that holds @p Capacity.
+	 * - with table_columns::prefix, the first 8 characters of every row as a big-endian integer.
+	 * - with table_columns::hash, the hash_bytes of every row.
+	 *
+	 * The batch operations write one result per row. equal_mask reads only the size and prefix columns
+	 * (a loop the compiler vectorizes) and goes to the slab only for candidates longer than 8 characters,
+	 * which it compares 8 bytes at a time, padding included.
+	 * ASCII case mapping is one kernel call over the whole slab.
+	 *
+	 * Rows are read as std::string_view, or copied out as string_impl with row(). Inputs longer than
+	 * @p Capacity are handled by the overflow policy of @p Policy, as in append_inplace.
+	 *
+	 * With HYBSTR_PARALLEL defined, each batch operation also has an overload that takes an execution
+	 * policy as its first argument. That overload runs std::for_each over blocks of 'block_rows' rows.
+	 * @code
+	 * hybstr::string_table<32> tags;
+	 * tags.push_back("cpu");
+	 * tags.push_back("mem");
+	 * const auto mask = tags.equal_mask("mem");                             // {0, 1}
+	 * const auto same = tags.equal_mask(std::execution::par_unseq, "mem");  // with HYBSTR_PARALLEL
+	 * @endcode
+	 */
+	template<std::size_t Capacity, table_columns Columns = table_columns::prefix, typename Policy = default_policy>
+	class string_table
+	{
+		static_assert(Capacity > 0, "string_table rows must hold at least one character");
+	public:
+		using size_type = std::size_t;
+		using length_type = detail::size_field_t<Capacity>;
+		using row_type = string_impl<Capacity, HYBSTR_DYNAMIC_EXPAND_CAPACITY, Policy>;
+
+		/// @brief "Not found" position returned by find_each.
+		static constexpr size_type npos = detail::npos;
+		/// @brief Distance between two rows in the slab: @p Capacity rounded up to a multiple of 8, so that rows are compared a word at a time.
+		static constexpr size_type stride = (Capacity + 7) / 8 * 8;
+		/// @brief Rows per task in the execution policy overloads.
+		static constexpr size_type block_rows = 4096;
+		static constexpr bool has_prefixes = detail::has_column(Columns, table_columns::prefix);
+		static constexpr bool has_hashes = detail::has_column(Columns, table_columns::hash);
+
+		string_table() = default;
+
+		/** @return Number of rows. */
+		[[nodiscard]] auto size() const noexcept -> size_type
+		{
+			return _sizes.size();
+		}
+		/** @return True if the table has no rows. */
+		[[nodiscard]] auto empty() const noexcept -> bool
+		{
+			return _sizes.empty();
+		}
+		/** @return Maximum number of characters in a row. */
+		[[nodiscard]] static constexpr auto row_capacity() noexcept -> size_type
+		{
+			return Capacity;
+		}
+
+		/** @brief Allocates every column for @p rows rows. */
+		void reserve(size_type rows)
+		{
+			_chars.reserve(rows * stride);
+			_sizes.reserve(rows);
+			if constexpr (has_prefixes)
+			{
+				_prefixes.reserve(rows);
+			}
+			if constexpr (has_hashes)
+			{
+				_hashes.reserve(rows);
+			}
+		}
+		/** @brief Removes every row. */
+		void clear() noexcept
+		{
+			_chars.clear();
+			_sizes.clear();
+			_prefixes.clear();
+			_hashes.clear();
+		}
+
+		/**
+		 * @brief Appends a row with the contents of @p sv.
+		 * @return Index of the new row.
+		 */
+		auto push_back(std::string_view sv) -> size_type
+		{
+			const size_type n = _fit(sv.size());
+			// 'sv' may be a row of this table ('t.push_back(t[0])'), which the resize can move.
+			std::array<char, stride> staged;
+			detail::copy_chars(staged.data(), sv.data(), n);
+			const size_type i = size();
+			_chars.resize(_chars.size() + stride);
+			_sizes.push_back(0);
+			if constexpr (has_prefixes)
+			{
+				_prefixes.push_back(0);
+			}
+			if constexpr (has_hashes)
+			{
+				_hashes.push_back(0);
+			}
+			_store(i, staged.data(), n);
+			return i;
+		}
+		/** @copydoc push_back(std::string_view) */
+		template<std::size_t N, std::size_t ExpandCapacity, typename OtherPolicy>
+		auto push_back(const string_impl<N, ExpandCapacity, OtherPolicy>& s) -> size_type
+		{
+			return push_back(s.view());
+		}
+		/** @brief Replaces the contents of row @p i with @p sv. */
+		void assign(size_type i, std::string_view sv)
+		{
+			_store(i, sv.data(), _fit(sv.size()));
+		}
+
+		/** @return Number of characters in row @p i. */
+		[[nodiscard]] auto length(size_type i) const noexcept -> size_type
+		{
+			return _sizes[i];
+		}
+		/** @return Characters of row @p i. They are not null-terminated when the row is full. */
+		[[nodiscard]] auto data(size_type i) const noexcept -> const char*
+		{
+			return _row(i);
+		}
+		/** @return View of row @p i. */
+		[[nodiscard]] auto view(size_type i) const noexcept -> std::string_view
+		{
+			return std::string_view(_row(i), _sizes[i]);
+		}
+		/** @return View of row @p i. */
+		[[nodiscard]] auto operator[](size_type i) const noexcept -> std::string_view
+		{
+			return view(i);
+		}
+		/** @return Copy of row @p i as a string_impl. */
+		[[nodiscard]] auto row(size_type i) const noexcept -> row_type
+		{
+			return row_type(view(i));
+		}
+		/** @return Same value as 'prefix_key(data(i), length(i), 0)'. */
+		[[nodiscard]] auto prefix(size_type i) const noexcept -> std::uint64_t
+		{
+			if constexpr (has_prefixes)
+			{
+				return _prefixes[i];
+			}
+			else
+			{
+				return detail::load_be64(_row(i));
+			}
+		}
+		/** @return Same value as 'hash_bytes(view(i))'. */
+		[[nodiscard]] auto hash(size_type i) const noexcept -> std::uint64_t
+		{
+			if constexpr (has_hashes)
+			{
+				return _hashes[i];
+			}
+			else
+			{
+				return hash_bytes(view(i));
+			}
+		}
+
+		/** @return The character slab, 'size() * stride' bytes. */
+		[[nodiscard]] auto slab() const noexcept -> const char*
+		{
+			return _chars.data();
+		}
+		/** @return The size column, 'size()' entries. */
+		[[nodiscard]] auto sizes() const noexcept -> const length_type*
+		{
+			return _sizes.data();
+		}
+		/** @return The prefix column, 'size()' entries. Requires table_columns::prefix. */
+		[[nodiscard]] auto prefixes() const noexcept -> const std::uint64_t*
+		{
+			static_assert(has_prefixes, "string_table has no prefix column");
+			return _prefixes.data();
+		}
+		/** @return The hash column, 'size()' entries. Requires table_columns::hash. */
+		[[nodiscard]] auto hashes() const noexcept -> const std::uint64_t*
+		{
+			static_assert(has_hashes, "string_table has no hash column");
+			return _hashes.data();
+		}
+
+		/** @return One byte per row: 1 if the row equals @p sv, 0 otherwise. */
+		[[nodiscard]] auto equal_mask(std::string_view sv) const -> std::vector<std::uint8_t>
+		{
+			std::vector<std::uint8_t> mask(size());
+			_equal_block(sv, mask.data(), 0, size());
+			return mask;
+		}
+		/** @return For each row, the position of the first occurrence of @p needle, or npos. */
+		[[nodiscard]] auto find_each(std::string_view needle) const -> std::vector<size_type>
+		{
+			std::vector<size_type> positions(size());
+			_find_block(needle, positions.data(), 0, size());
+			return positions;
+		}
+		/** @return hash_bytes of each row. */
+		[[nodiscard]] auto hash_each() const -> std::vector<std::uint64_t>
+		{
+			if constexpr (has_hashes)
+			{
+				return _hashes;
+			}
+			else
+			{
+				std::vector<std::uint64_t> hashes(size());
+				_hash_block(hashes.data(), 0, size());
+				return hashes;
+			}
+		}
+		/** @brief Replaces each character c of every row with 'f(c)', then updates the prefix and hash columns. */
+		template<typename F>
+		void transform(F f)
+		{
+			_transform_block(f, 0, size());
 		}
-		/** @return Maximum number of characters in the fixed buffer. */
-		[[nodiscard]] constexpr auto capacity() const noexcept -> size_type
+		/** @brief Converts the ASCII letters of every row to upper case. */
+		void to_upper_inplace() noexcept
 		{
-			return BufferCapacity;
+			_flip_case_block<'a', 'z'>(0, size());
 		}
-		/** @return True if the string is empty. */
-		[[nodiscard]] constexpr auto empty() const noexcept -> bool
+		/** @brief Converts the ASCII letters of every row to lower case. */
+		void to_lower_inplace() noexcept
 		{
-			return _size == 0;
+			_flip_case_block<'A', 'Z'>(0, size());
 		}
 
-		/** @return Mutable pointer to internal buffer. */
-		[[nodiscard]] constexpr auto data() noexcept -> pointer
+#if HYBSTR_HAS_PARALLEL
+		/** @copydoc equal_mask(std::string_view) const */
+		template<typename ExecutionPolicy, typename = detail::execution_policy_t<ExecutionPolicy>>
+		[[nodiscard]] auto equal_mask(ExecutionPolicy&& exec, std::string_view sv) const -> std::vector<std::uint8_t>
 		{
-			return _data.data();
+			std::vector<std::uint8_t> mask(size());
+			_for_blocks(std::forward<ExecutionPolicy>(exec), [&](size_type first, size_type last) { _equal_block(sv, mask.data(), first, last); });
+			return mask;
 		}
-		/** @return Const pointer to internal buffer. */
-		[[nodiscard]] constexpr auto data() const noexcept -> const_pointer
+		/** @copydoc find_each(std::string_view) const */
+		template<typename ExecutionPolicy, typename = detail::execution_policy_t<ExecutionPolicy>>
+		[[nodiscard]] auto find_each(ExecutionPolicy&& exec, std::string_view needle) const -> std::vector<size_type>
 		{
-			return _data.data();
+			std::vector<size_type> positions(size());
+			_for_blocks(std::forward<ExecutionPolicy>(exec), [&](size_type first, size_type last) { _find_block(needle, positions.data(), first, last); });
+			return positions;
 		}
-		/** @return Null-terminated C-string. */
-		[[nodiscard]] constexpr auto c_str() const noexcept -> const_pointer
+		/** @copydoc hash_each() const */
+		template<typename ExecutionPolicy, typename = detail::execution_policy_t<ExecutionPolicy>>
+		[[nodiscard]] auto hash_each(ExecutionPolicy&& exec) const -> std::vector<std::uint64_t>
+		{
+			if constexpr (has_hashes)
+			{
+				return _hashes;
+			}
+			else
+			{
+				std::vector<std::uint64_t> hashes(size());
+				_for_blocks(std::forward<ExecutionPolicy>(exec), [&](size_type first, size_type last) { _hash_block(hashes.data(), first, last); });
+				return hashes;
+			}
+		}
+		/** @copydoc transform(F) */
+		template<typename ExecutionPolicy, typename F, typename = detail::execution_policy_t<ExecutionPolicy>>
+		void transform(ExecutionPolicy&& exec, F f)
 		{
-			return _data.data();
+			_for_blocks(std::forward<ExecutionPolicy>(exec), [&](size_type first, size_type last) { _transform_block(f, first, last); });
 		}
-		/** @return Read-only view of the string. */
-		[[nodiscard]] constexpr auto view() const noexcept -> view_type
+		/** @copydoc to_upper_inplace() */
+		template<typename ExecutionPolicy, typename = detail::execution_policy_t<ExecutionPolicy>>
+		void to_upper_inplace(ExecutionPolicy&& exec)
 		{
-			return std::string_view(_data.data(), _size);
+			_for_blocks(std::forward<ExecutionPolicy>(exec), [&](size_type first, size_type last) { _flip_case_block<'a', 'z'>(first, last); });
 		}
-		/** @return A new std::string copy of the contents (runtime). */
-		[[nodiscard]] auto str() const -> std::string
+		/** @copydoc to_lower_inplace() */
+		template<typename ExecutionPolicy, typename = detail::execution_policy_t<ExecutionPolicy>>
+		void to_lower_inplace(ExecutionPolicy&& exec)
 		{
-			return std::string(begin(), end());
+			_for_blocks(std::forward<ExecutionPolicy>(exec), [&](size_type first, size_type last) { _flip_case_block<'A', 'Z'>(first, last); });
 		}
+#endif
 
-
-		/** @brief Accesses a character by index (mutable). */
-		[[nodiscard]] constexpr auto operator[](size_type i) noexcept -> reference
+	private:
+		[[nodiscard]] auto _row(size_type i) noexcept -> char*
 		{
-			return _data[i];
+			return _chars.data() + i * stride;
 		}
-		/** @brief Accesses a character by index (const). */
-		[[nodiscard]] constexpr auto operator[](size_type i) const noexcept -> const_reference
+		[[nodiscard]] auto _row(size_type i) const noexcept -> const char*
 		{
-			return _data[i];
+			return _chars.data() + i * stride;
 		}
 
-		[[nodiscard]] constexpr auto begin() noexcept -> iterator
+		/** @brief Number of characters kept from an input of @p n, after the overflow policy. */
+		[[nodiscard]] static auto _fit(size_type n) noexcept(detail::overflow_nothrow_v<Policy>) -> size_type
 		{
-			return _data.begin();
+			if (n > Capacity)
+			{
+				detail::stats_overflow();
+				return detail::overflow_handler<typename Policy::overflow>::handle(n, Capacity);
+			}
+			return n;
 		}
-		[[nodiscard]] constexpr auto begin() const noexcept -> const_iterator
+
+		/** @brief Writes @p n characters to row @p i and zeroes its padding. @p in may point into the row. */
+		void _store(size_type i, const char* in, size_type n) noexcept
 		{
-			return _data.begin();
+			detail::move_chars(_row(i), in, n);
+			std::memset(_row(i) + n, 0, stride - n);
+			_sizes[i] = static_cast<length_type>(n);
+			_update(i);
 		}
-		[[nodiscard]] constexpr auto cbegin() const noexcept -> const_iterator
+
+		/** @brief Recomputes the prefix and hash columns of row @p i. */
+		void _update(size_type i) noexcept
 		{
-			return _data.cbegin();
+			if constexpr (has_prefixes)
+			{
+				// The padding is zero, so the load already matches prefix_key.
+				_prefixes[i] = detail::load_be64(_row(i));
+			}
+			if constexpr (has_hashes)
+			{
+				_hashes[i] = hash_bytes(view(i));
+			}
 		}
-		[[nodiscard]] constexpr auto end() noexcept -> iterator
+
+		void _equal_block(std::string_view sv, std::uint8_t* out, size_type first, size_type last) const
 		{
-			return _data.begin() + _size;
+			const size_type n = sv.size();
+			if (n > Capacity)
+			{
+				std::fill(out + first, out + last, std::uint8_t{ 0 });
+				return;
+			}
+			// Words of @p sv as they would appear in a row, zero padding included.
+			std::vector<std::uint64_t> words((n + 7) / 8);
+			for (size_type w = 0; w < words.size(); ++w)
+			{
+				words[w] = detail::prefix_key(sv.data(), n, 8 * w);
+			}
+			const auto target = static_cast<length_type>(n);
+			size_type checked = 0;
+			if constexpr (has_prefixes)
+			{
+				const std::uint64_t key = words.empty() ? 0 : words[0];
+				for (size_type i = first; i < last; ++i)
+				{
+					out[i] = static_cast<std::uint8_t>((_sizes[i] == target) & (_prefixes[i] == key));
+				}
+				if (n <= 8)
+				{
+					return;
+				}
+				checked = 1;
+			}
+			else
+			{
+				for (size_type i = first; i < last; ++i)
+				{
+					out[i] = static_cast<std::uint8_t>(_sizes[i] == target);
+				}
+			}
+			for (size_type i = first; i < last; ++i)
+			{
+				if (out[i])
+				{
+					const char* p = _row(i);
+					bool equal = true;
+					for (size_type w = checked; w < words.size(); ++w)
+					{
+						equal &= detail::load_be64(p + 8 * w) == words[w];
+					}
+					out[i] = static_cast<std::uint8_t>(equal);
+				}
+			}
 		}
-		[[nodiscard]] constexpr auto end() const noexcept -> const_iterator
+
+		void _find_block(std::string_view needle, size_type* out, size_type first, size_type last) const noexcept
 		{
-			return _data.begin() + _size;
+			for (size_type i = first; i < last; ++i)
+			{
+				out[i] = detail::find_chars(_row(i), _sizes[i], needle.data(), needle.size(), 0);
+			}
 		}
-		[[nodiscard]] constexpr auto cend() const noexcept -> const_iterator
+
+		void _hash_block(std::uint64_t* out, size_type first, size_type last) const noexcept
 		{
-			return _data.begin() + _size;
+			for (size_type i = first; i < last; ++i)
+			{
+				out[i] = hash_bytes(view(i));
+			}
 		}
-		[[nodiscard]] constexpr auto rbegin() noexcept -> reverse_iterator
+
+		template<typename F>
+		void _transform_block(F& f, size_type first, size_type last)
 		{
-			return _data.rbegin() + 1;
+			for (size_type i = first; i < last; ++i)
+			{
+				char* p = _row(i);
+				for (size_type j = 0, n = _sizes[i]; j < n; ++j)
+				{
+					p[j] = static_cast<char>(f(p[j]));
+				}
+				_update(i);
+			}
 		}
-		[[nodiscard]] constexpr auto rbegin() const noexcept -> const_reverse_iterator
+
+		template<char First, char Last>
+		void _flip_case_block(size_type first, size_type last) noexcept
 		{
-			return _data.rbegin() + 1;
+			// The padding is zero and stays zero, so the rows are mapped as one range.
+			detail::flip_case_chars<First, Last>(_row(first), _row(first), (last - first) * stride);
+			for (size_type i = first; i < last; ++i)
+			{
+				_update(i);
+			}
 		}
-		[[nodiscard]] constexpr auto crbegin() const noexcept -> const_reverse_iterator
+
+#if HYBSTR_HAS_PARALLEL
+		/** @brief Calls 'fn(first, last)' for each block of rows, under @p exec. */
+		template<typename ExecutionPolicy, typename F>
+		void _for_blocks(ExecutionPolicy&& exec, F fn) const
 		{
-			return _data.crbegin() + 1;
+			std::vector<size_type> firsts((size() + block_rows - 1) / block_rows);
+			for (size_type b = 0; b < firsts.size(); ++b)
+			{
+				firsts[b] = b * block_rows;
+			}
+			const size_type rows = size();
+			std::for_each(std::forward<ExecutionPolicy>(exec), firsts.begin(), firsts.end(),
+				[&fn, rows](size_type first) { fn(first, std::min(first + block_rows, rows)); });
 		}
-		[[nodiscard]] constexpr auto rend() noexcept -> reverse_iterator
+#endif
+
+		std::vector<char> _chars;
+		std::vector<length_type> _sizes;
+		std::vector<std::uint64_t> _prefixes; ///< Empty without table_columns::prefix.
+		std::vector<std::uint64_t> _hashes;   ///< Empty without table_columns::hash.
+	};
+
+	// ======================================================================
+	//                           Splitting
+	// ======================================================================
+
+	/**
+	 * @brief Lazy range of the tokens of a string, separated by a delimiter.
+	 *
+	 * @details
+	 * Yields 'std::string_view's into the original characters, so the tokenized string must outlive
+	 * the tokenizer. Consecutive delimiters produce empty tokens and a text with @c k delimiters has
+	 * @c k + 1 tokens. Delimiters are found with the search kernels (memchr and, for
+	 * multi-character delimiters, the SSE2 prefilter), and the whole class works in constant expressions.
+	 * @code
+	 * for (std::string_view pair : hybstr::split(query, '&'))
+	 * {
+	 *     ...
+	 * }
+	 * @endcode
+	 *
+	 * @tparam Delimiter 'char', or 'std::string_view' for a non-empty multi-character delimiter.
+	 */
+	template<typename Delimiter = char>
+	class tokenizer
+	{
+		static_assert(std::is_same_v<Delimiter, char> || std::is_same_v<Delimiter, std::string_view>,
+			"hybstr::tokenizer: the delimiter must be a char or a std::string_view");
+
+	public:
+		/** @brief Forward iterator over the tokens. */
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const std::string_view*;
+			using reference = std::string_view;
+
+			constexpr iterator() noexcept = default;
+
+			[[nodiscard]] constexpr auto operator*() const noexcept -> std::string_view
+			{
+				return _owner->_text.substr(_begin, _end - _begin);
+			}
+			constexpr auto operator++() noexcept -> iterator&
+			{
+				if (_end == _owner->_text.size())
+				{
+					_begin = detail::npos;
+					_end = detail::npos;
+				}
+				else
+				{
+					_begin = _end + _owner->_delimiter_size();
+					_end = _owner->_find(_begin);
+				}
+				return *this;
+			}
+			constexpr auto operator++(int) noexcept -> iterator
+			{
+				iterator copy = *this;
+				++*this;
+				return copy;
+			}
+			[[nodiscard]] friend constexpr auto operator==(const iterator& lhs, const iterator& rhs) noexcept -> bool
+			{
+				return lhs._begin == rhs._begin;
+			}
+			[[nodiscard]] friend constexpr auto operator!=(const iterator& lhs, const iterator& rhs) noexcept -> bool
+			{
+				return lhs._begin != rhs._begin;
+			}
+
+		private:
+			friend class tokenizer;
+
+			constexpr iterator(const tokenizer* owner, std::size_t begin, std::size_t end) noexcept
+				: _owner(owner), _begin(begin), _end(end)
+			{
+			}
+
+			const tokenizer* _owner = nullptr;
+			std::size_t _begin = detail::npos; ///< Start of the current token, npos past the last one.
+			std::size_t _end = detail::npos;   ///< End of the current token.
+		};
+
+		/**
+		 * @brief Tokenizes @p text on @p delimiter.
+		 * @param text Characters to split, referenced and not copied.
+		 * @param delimiter Separator; a 'std::string_view' delimiter must not be empty.
+		 */
+		constexpr tokenizer(std::string_view text, Delimiter delimiter) noexcept
+			: _text(text), _delimiter(delimiter)
 		{
-			return _data.rend();
+			assert(_delimiter_size() != 0 && "hybstr::tokenizer: empty delimiter");
 		}
-		[[nodiscard]] constexpr auto rend() const noexcept -> const_reverse_iterator
+
+		[[nodiscard]] constexpr auto begin() const noexcept -> iterator
 		{
-			return _data.rend();
+			return iterator(this, 0, _find(0));
 		}
-		[[nodiscard]] constexpr auto crend() const noexcept -> const_reverse_iterator
+		[[nodiscard]] constexpr auto end() const noexcept -> iterator
 		{
-			return _data.crend();
+			return iterator();
 		}
 
-		/**
-		 * @brief Replaces a character at compile time.
-		 * @tparam N Index to replace (must be less than BufferCapacity).
-		 * @param c New character value.
-		 * @return A new string_impl with the modified character.
-		 */
-		template <std::size_t N>
-		[[nodiscard]] constexpr auto set(char c) const noexcept
+		/** @return Number of tokens (one more than the number of delimiters). */
+		[[nodiscard]] constexpr auto count() const noexcept -> std::size_t
 		{
-			static_assert(N >= 0 && N < BufferCapacity, "index out of bound");
-			string_impl<BufferCapacity, DynamicExpandCapacity> result{};
-			for (std::size_t i = 0; i < _size; ++i)
+			std::size_t n = 0;
+			for (auto it = begin(); it != end(); ++it)
 			{
-				result._data[i] = _data[i];
+				++n;
 			}
-			result._size = _size;
-			result._data[N] = c;
-			result._data[result._size] = '\0';
-
-			return result;
+			return n;
 		}
 
 		/**
-		 * @brief Appends a C-style string literal.
-		 * @tparam N Number of characters including null terminator.
-		 * @return A new string_impl containing the concatenated result.
+		 * @brief Pull-style access: stores the next token in @p token.
+		 * @return False once all tokens have been returned.
 		 */
-		template <std::size_t N>
-		[[nodiscard]] constexpr auto append(const char(&str)[N]) const noexcept
+		constexpr auto next(std::string_view& token) noexcept -> bool
 		{
-			string_impl<BufferCapacity + N - 1, DynamicExpandCapacity> result{};
+			if (_position == detail::npos)
+			{
+				return false;
+			}
+			const std::size_t end = _find(_position);
+			token = _text.substr(_position, end - _position);
+			_position = end == _text.size() ? detail::npos : end + _delimiter_size();
+			return true;
+		}
 
-			for (std::size_t i = 0; i < _size; ++i)
+	private:
+		[[nodiscard]] constexpr auto _delimiter_size() const noexcept -> std::size_t
+		{
+			if constexpr (std::is_same_v<Delimiter, char>)
+			{
+				return 1;
+			}
+			else
+			{
+				return _delimiter.size();
+			}
+		}
+		/** @return Position of the next delimiter at or after @p pos, or the text size. */
+		[[nodiscard]] constexpr auto _find(std::size_t pos) const noexcept -> std::size_t
+		{
+			std::size_t found = detail::npos;
+			if constexpr (std::is_same_v<Delimiter, char>)
 			{
-				result._data[i] = _data[i];
+				found = detail::find_char(_text.data(), _text.size(), _delimiter, pos);
 			}
-			for (std::size_t i = 0; i < N - 1; ++i)
+			else
 			{
-				result._data[_size + i] = str[i];
+				found = detail::find_chars(_text.data(), _text.size(), _delimiter.data(), _delimiter.size(), pos);
 			}
+			return found == detail::npos ? _text.size() : found;
+		}
 
-			result._size = _size + (N - 1);
-			result._data[result._size] = '\0';
+		std::string_view _text;
+		Delimiter _delimiter;
+		std::size_t _position = 0; ///< Start of the token returned by the next call to 'next'.
+	};
 
-			return result;
+	/** @brief Splits @p text on @p delimiter without copying. */
+	[[nodiscard]] constexpr auto split(std::string_view text, char delimiter) noexcept -> tokenizer<char>
+	{
+		return tokenizer<char>(text, delimiter);
+	}
+	/** @brief Splits @p text on the non-empty @p delimiter without copying. */
+	[[nodiscard]] constexpr auto split(std::string_view text, std::string_view delimiter) noexcept -> tokenizer<std::string_view>
+	{
+		return tokenizer<std::string_view>(text, delimiter);
+	}
+	/** @brief Splits the contents of @p str, which must outlive the tokenizer. */
+	template<std::size_t B, std::size_t D, typename P>
+	[[nodiscard]] constexpr auto split(const string_impl<B, D, P>& str, char delimiter) noexcept -> tokenizer<char>
+	{
+		return tokenizer<char>(str.view(), delimiter);
+	}
+	/** @brief Splits the contents of @p str, which must outlive the tokenizer. */
+	template<std::size_t B, std::size_t D, typename P>
+	[[nodiscard]] constexpr auto split(const string_impl<B, D, P>& str, std::string_view delimiter) noexcept -> tokenizer<std::string_view>
+	{
+		return tokenizer<std::string_view>(str.view(), delimiter);
+	}
+	/// @brief Deleted: the tokens would point into a destroyed temporary.
+	template<std::size_t B, std::size_t D, typename P>
+	auto split(const string_impl<B, D, P>&& str, char delimiter) -> tokenizer<char> = delete;
+	/// @brief Deleted: the tokens would point into a destroyed temporary.
+	template<std::size_t B, std::size_t D, typename P>
+	auto split(const string_impl<B, D, P>&& str, std::string_view delimiter) -> tokenizer<std::string_view> = delete;
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	namespace detail
+	{
+		/// @brief Delimiter of a compile-time split: a 'char' as is, a string_impl as its view.
+		template<auto Delim>
+		consteval auto split_delimiter() noexcept
+		{
+			if constexpr (std::is_same_v<std::remove_cvref_t<decltype(Delim)>, char>)
+			{
+				return Delim;
+			}
+			else
+			{
+				static_assert(is_string_impl_v<std::remove_cvref_t<decltype(Delim)>>, "Expect a char or a hybstr::string_impl delimiter");
+				return Delim.view();
+			}
 		}
 
-		/**
-		 * @brief Appends another hybrid string.
-		 * @tparam TargetSize Buffer expansion size for the result.
-		 * @tparam N BufferCapacity of the other string.
-		 * @tparam ExpandCapacity Dynamic capacity of the other string.
-		 * @return A new string_impl combining both contents.
-		 */
-		template<std::size_t TargetSize = DynamicExpandCapacity, std::size_t N, std::size_t ExpandCapacity>
-		[[nodiscard]] constexpr auto append(const string_impl<N, ExpandCapacity>& other) const noexcept
+		/** @brief Tokens of @p Str, computed once per distinct string and delimiter. */
+		template<auto Str, auto Delim>
+		struct split_table
 		{
-			string_impl<
-				BufferCapacity + TargetSize, 
-				std::max(DynamicExpandCapacity, ExpandCapacity)
-			> result{};
+			static constexpr std::string_view text = Str.view();
+			static constexpr auto delimiter = split_delimiter<Delim>();
+			static constexpr std::size_t count = tokenizer<std::remove_const_t<decltype(delimiter)>>(text, delimiter).count();
 
-			for (std::size_t i = 0; i < _size; ++i)
+			static consteval auto make_views() noexcept -> std::array<std::string_view, count>
 			{
-				result._data[i] = _data[i];
+				std::array<std::string_view, count> result{};
+				std::size_t i = 0;
+				for (std::string_view token : tokenizer<std::remove_const_t<decltype(delimiter)>>(text, delimiter))
+				{
+					result[i++] = token;
+				}
+				return result;
 			}
-			for (std::size_t i = 0; i < other.size(); ++i)
+
+			static constexpr std::array<std::string_view, count> views = make_views();
+
+			static consteval auto longest() noexcept -> std::size_t
 			{
-				result._data[_size + i] = other._data[i];
+				std::size_t n = 0;
+				for (std::string_view token : views)
+				{
+					n = std::max(n, token.size());
+				}
+				return n;
 			}
+		};
+	} // namespace detail
 
-			result._size = _size + other.size();
-			result._data[result._size] = '\0';
-			return result;
+	/**
+	 * @brief Splits @p Str at compile time into an array of strings sized for the longest token. C++20 or above.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * constexpr auto methods = hybstr::split<"GET,PUT,POST"_hyb, ','>();   // std::array<string_impl<4>, 3>
+	 * static_assert(methods[2] == hybstr::string("POST"));
+	 * @endcode
+	 * @tparam Str String to split, a hybstr::string_impl instance.
+	 * @tparam Delim 'char' or hybstr::string_impl delimiter.
+	 */
+	template<auto Str, auto Delim>
+	[[nodiscard]] consteval auto split()
+	{
+		static_assert(is_string_impl_v<std::remove_cvref_t<decltype(Str)>>, "Expect a hybstr::string_impl as input");
+
+		using table = detail::split_table<Str, Delim>;
+		std::array<string_impl<table::longest()>, table::count> result{};
+		for (std::size_t i = 0; i < table::count; ++i)
+		{
+			result[i] = string_impl<table::longest()>(table::views[i]);
 		}
+		return result;
+	}
+
+	/**
+	 * @brief Splits @p Str at compile time into views of a static copy of @p Str. C++20 or above.
+	 * @return A reference to an array with static storage duration, usable at runtime too.
+	 */
+	template<auto Str, auto Delim>
+	[[nodiscard]] constexpr auto split_views() noexcept -> const auto&
+	{
+		static_assert(is_string_impl_v<std::remove_cvref_t<decltype(Str)>>, "Expect a hybstr::string_impl as input");
+		return detail::split_table<Str, Delim>::views;
+	}
+#endif
+
+	// ======================================================================
+	//                           Output
+	// ======================================================================
+
+	namespace detail
+	{
 		/**
-		 * @brief Appends a std::string_view.
-		 * @tparam TargetSize Buffer expansion size for the result.
+		 * @brief Calls @p write, which writes @p size characters to @p os, padded to the stream width.
+		 * Honors the fill character and left / right adjustment, and resets the width like other insertions.
 		 */
-		template<std::size_t TargetSize = DynamicExpandCapacity>
-		[[nodiscard]] constexpr auto append(std::string_view sv) const noexcept
+		template<typename Stream, typename F>
+		auto write_padded(Stream& os, std::size_t size, const F& write) -> Stream&
 		{
-			if (HYBSTR_IS_CONSTANT_EVALUATED)
+			const typename Stream::sentry guard(os);
+			if (guard)
 			{
-				string_impl<BufferCapacity + TargetSize, DynamicExpandCapacity> result{};
-				for (std::size_t i = 0; i < _size; ++i)
+				const std::size_t width = os.width() > 0 ? static_cast<std::size_t>(os.width()) : 0;
+				const std::size_t padding = width > size ? width - size : 0;
+				const bool left = (os.flags() & Stream::adjustfield) == Stream::left;
+				if (!left)
 				{
-					result._data[i] = _data[i];
+					for (std::size_t i = 0; i < padding; ++i) os.put(os.fill());
 				}
-				for (std::size_t i = 0; i < sv.size(); ++i)
+				write();
+				if (left)
 				{
-					result._data[_size + i] = sv[i];
+					for (std::size_t i = 0; i < padding; ++i) os.put(os.fill());
 				}
-				result._size = _size + sv.size();
-				result._data[result._size] = '\0';
-				return result;
 			}
-			else
+			os.width(0);
+			return os;
+		}
+	} // namespace detail
+
+	/** @brief Writes the characters of @p str to @p os, without an intermediate std::string. */
+	template<typename Traits, std::size_t B, std::size_t D, typename P>
+	auto operator<<(std::basic_ostream<char, Traits>& os, const string_impl<B, D, P>& str) -> std::basic_ostream<char, Traits>&
+	{
+		return detail::write_padded(os, str.size(), [&os, &str]
+		{
+			os.write(str.data(), static_cast<std::streamsize>(str.size()));
+		});
+	}
+
+	/** @brief Writes every operand of @p expr to @p os in turn, without materializing it. */
+	template<typename Traits, typename L, typename R>
+	auto operator<<(std::basic_ostream<char, Traits>& os, const concat_expr<L, R>& expr) -> std::basic_ostream<char, Traits>&
+	{
+		return detail::write_padded(os, expr.size(), [&os, &expr]
+		{
+			expr.for_each_piece([&os](std::string_view piece)
+			{
+				os.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+			});
+		});
+	}
+
+#if HYBSTR_HAS_IOVEC
+	/**
+	 * @brief One 'iovec' per operand of @p expr, for 'writev' / 'sendmsg' without flattening the chain.
+	 * The segments point into @p expr and its operands, which must outlive them.
+	 * @code
+	 * auto line = hybstr::lazy(prefix) + route + ' ' + status + "\r\n";
+	 * auto iov = hybstr::to_iovec(line);
+	 * ::writev(fd, iov.data(), static_cast<int>(iov.size()));
+	 * @endcode
+	 */
+	template<typename L, typename R>
+	[[nodiscard]] auto to_iovec(const concat_expr<L, R>& expr) noexcept -> std::array<::iovec, concat_expr<L, R>::piece_count>
+	{
+		std::array<::iovec, concat_expr<L, R>::piece_count> result{};
+		std::size_t i = 0;
+		expr.for_each_piece([&result, &i](std::string_view piece) noexcept
+		{
+			result[i].iov_base = const_cast<char*>(piece.data());
+			result[i].iov_len = piece.size();
+			++i;
+		});
+		return result;
+	}
+
+	/** @brief A single 'iovec' over the characters of @p str. */
+	template<std::size_t B, std::size_t D, typename P>
+	[[nodiscard]] auto to_iovec(const string_impl<B, D, P>& str) noexcept -> ::iovec
+	{
+		::iovec result{};
+		result.iov_base = const_cast<char*>(str.data());
+		result.iov_len = str.size();
+		return result;
+	}
+#endif
+
+	// ======================================================================
+	//                           Pattern Matching
+	// ======================================================================
+
+#if HYBSTR_CPP_20_OR_ABOVE
+	namespace detail
+	{
+		/// @brief A piece of a parsed match pattern.
+		struct match_segment
+		{
+			enum class kind : unsigned char
 			{
-				// "string_impl overflow; increase the dynamic buffer size"
-				assert(sv.size() < TargetSize);
+				literal,  ///< Characters of the unescaped text at [begin, begin + length).
+				any,      ///< '?': one character.
+				set,      ///< '[...]': one character in 'chars'.
+				capture,  ///< '{name}': one or more characters other than '/'.
+				wildcard  ///< '*': any characters, possibly none.
+			};
 
-				string_impl<BufferCapacity + TargetSize, DynamicExpandCapacity> result{};
+			kind type = kind::literal;
+			std::size_t begin = 0;     ///< Literal: offset in the unescaped text. Capture: offset of the name in the pattern.
+			std::size_t length = 0;    ///< Literal: number of characters. Capture: length of the name.
+			std::size_t slot = npos;   ///< Capture and wildcard: index of the captured view.
+			byte_set chars{};          ///< Set: accepted characters.
+		};
 
-				std::copy_n(_data.data(), _size, result._data.data());
-				std::copy_n(sv.data(), sv.size(), result._data.data() + _size);
-				result._size = _size + sv.size();
-				result._data[result._size] = '\0';
-				return result;
-			}
-		}
 		/**
-		 * @brief Appends one or more repeated characters.
-		 * @tparam N Number of characters to add.
+		 * @brief Parses @p pattern into segments written to @p out, and its unescaped literal text to @p text,
+		 * unless they are null.
+		 * @return Number of segments.
 		 */
-		template<std::size_t N = 1>
-		[[nodiscard]] constexpr auto append(char c) const noexcept
+		consteval auto parse_match(std::string_view pattern, match_segment* out, char* text) -> std::size_t
 		{
-			string_impl<BufferCapacity + N, DynamicExpandCapacity> result{};
-			for (std::size_t i = 0; i < _size; ++i)
-			{
-				result._data[i] = _data[i];
-			}
-			for (std::size_t i = 0; i < N; ++i)
+			std::size_t count = 0;
+			std::size_t text_size = 0;
+			std::size_t slots = 0;
+			bool in_literal = false;
+			const auto emit = [&](match_segment segment)
+				{
+					if (out)
+					{
+						out[count] = segment;
+					}
+					++count;
+					in_literal = false;
+				};
+			const auto literal = [&](char c)
+				{
+					if (text)
+					{
+						text[text_size] = c;
+					}
+					if (in_literal)
+					{
+						if (out)
+						{
+							++out[count - 1].length;
+						}
+					}
+					else
+					{
+						emit({ match_segment::kind::literal, text_size, 1 });
+						in_literal = true;
+					}
+					++text_size;
+				};
+
+			for (std::size_t i = 0; i < pattern.size(); ++i)
 			{
-				result._data[_size + i] = c;
+				const char c = pattern[i];
+				if (c == '\\')
+				{
+					if (++i == pattern.size())
+					{
+						throw "hybstr::match: pattern ends with '\\'";
+					}
+					literal(pattern[i]);
+				}
+				else if (c == '?')
+				{
+					emit({ match_segment::kind::any });
+				}
+				else if (c == '*')
+				{
+					while (i + 1 < pattern.size() && pattern[i + 1] == '*')
+					{
+						++i;
+					}
+					emit({ match_segment::kind::wildcard, 0, 0, slots++ });
+				}
+				else if (c == '{')
+				{
+					std::size_t close = i + 1;
+					while (close < pattern.size() && pattern[close] != '}')
+					{
+						++close;
+					}
+					if (close == pattern.size())
+					{
+						throw "hybstr::match: unterminated '{'";
+					}
+					emit({ match_segment::kind::capture, i + 1, close - i - 1, slots++ });
+					i = close;
+				}
+				else if (c == '[')
+				{
+					match_segment segment{ match_segment::kind::set };
+					std::size_t j = i + 1;
+					const bool negate = j < pattern.size() && pattern[j] == '^';
+					j += negate;
+					bool first = true;
+					for (; j < pattern.size() && (first || pattern[j] != ']'); ++j, first = false)
+					{
+						char low = pattern[j];
+						if (low == '\\' && j + 1 < pattern.size())
+						{
+							low = pattern[++j];
+						}
+						char high = low;
+						if (j + 2 < pattern.size() && pattern[j + 1] == '-' && pattern[j + 2] != ']')
+						{
+							high = pattern[j + 2];
+							j += 2;
+							if (high == '\\' && j + 1 < pattern.size())
+							{
+								high = pattern[++j];
+							}
+						}
+						if (static_cast<unsigned char>(high) < static_cast<unsigned char>(low))
+						{
+							throw "hybstr::match: reversed range in '[...]'";
+						}
+						for (unsigned ch = static_cast<unsigned char>(low); ch <= static_cast<unsigned char>(high); ++ch)
+						{
+							segment.chars.insert(static_cast<char>(ch));
+						}
+					}
+					if (j == pattern.size())
+					{
+						throw "hybstr::match: unterminated '['";
+					}
+					if (negate)
+					{
+						for (std::uint64_t& word : segment.chars._bits)
+						{
+							word = ~word;
+						}
+					}
+					emit(segment);
+					i = j;
+				}
+				else
+				{
+					literal(c);
+				}
 			}
-			result._size = _size + N;
-			result._data[result._size] = '\0';
-			return result;
+			return count;
 		}
 
-		/** @brief Appends a single character. */
-		[[nodiscard]] constexpr auto push_back(char c) const noexcept
+		/** @brief Pattern @p Pattern, parsed once per distinct string. */
+		template<auto Pattern>
+		struct parsed_match
 		{
-			return append<1>(c);
-		}
+			static constexpr std::string_view source = Pattern.view();
+			static constexpr std::size_t count = parse_match(source, nullptr, nullptr);
 
-		/**
-		 * @brief Resizes the string to a new compile-time capacity.
-		 * @tparam N New capacity.
-		 * @param c Fill character if expanded.
-		 * @return A new string_impl with resized storage.
-		 */
-		template<std::size_t N>
-		[[nodiscard]] constexpr auto resize(char c = ' ') const noexcept
-		{
-			string_impl<N, DynamicExpandCapacity> result{};
+			static consteval auto make_segments() -> std::array<match_segment, count>
+			{
+				std::array<match_segment, count> result{};
+				parse_match(source, result.data(), nullptr);
+				return result;
+			}
+			static consteval auto make_text() -> std::array<char, source.size() + 1>
+			{
+				std::array<char, source.size() + 1> result{};
+				parse_match(source, nullptr, result.data());
+				return result;
+			}
 
-			const std::size_t len = std::min(_size, N);
+			static constexpr std::array<match_segment, count> segments = make_segments();
+			static constexpr std::array<char, source.size() + 1> text = make_text();
 
-			for (std::size_t i = 0; i < len; ++i)
+			/** @return Number of captured views ('{...}' and '*'). */
+			static consteval auto captures() noexcept -> std::size_t
 			{
-				result._data[i] = _data[i];
+				std::size_t n = 0;
+				for (const match_segment& segment : segments)
+				{
+					n += segment.slot != npos;
+				}
+				return n;
 			}
-			for (std::size_t i = len; i < N; ++i)
+
+			/** @return Slot of the capture named @p name. */
+			static consteval auto slot_of(std::string_view name) -> std::size_t
 			{
-				result._data[i] = c;
+				for (const match_segment& segment : segments)
+				{
+					if (segment.type == match_segment::kind::capture && source.substr(segment.begin, segment.length) == name)
+					{
+						return segment.slot;
+					}
+				}
+				throw "hybstr::match: no capture with this name";
 			}
 
-			result._size = N;
-			result._data[result._size] = '\0';
+			/** @return Literal text of segment @p I. */
+			template<std::size_t I>
+			static constexpr std::string_view literal = std::string_view(text.data() + segments[I].begin, segments[I].length);
+		};
 
-			return result;
-		}
 		/**
-		 * @brief Ensures compile-time capacity is at least N.
-		 * If current capacity is smaller, a new string_impl is created.
+		 * @brief Matches segments I... of @p Parsed against @p input from @p pos to the end.
+		 * Captures and wildcards take the shortest run that lets the rest match, found with the search
+		 * kernels when a literal follows.
 		 */
-		template<std::size_t N>
-		[[nodiscard]] constexpr auto reserve() const noexcept
+		template<typename Parsed, std::size_t I>
+		constexpr auto match_from(std::string_view input, std::size_t pos, std::string_view* captures) noexcept -> bool
 		{
-			if constexpr (BufferCapacity < N)
+			if constexpr (I == Parsed::count)
 			{
-				string_impl<N, DynamicExpandCapacity> result{};
-				result._size = std::min(_size, N);
-
-				for (std::size_t i = 0; i < result._size; ++i)
-				{
-					result._data[i] = _data[i];
-				}
-
-				result._data[result._size] = '\0';
-				return result;
+				return pos == input.size();
 			}
 			else
 			{
-				return string_impl<N, DynamicExpandCapacity> { *this };
+				constexpr match_segment segment = Parsed::segments[I];
+				if constexpr (segment.type == match_segment::kind::literal)
+				{
+					constexpr std::string_view literal = Parsed::template literal<I>;
+					return input.size() - pos >= literal.size() &&
+						detail::equal_chars(input.data() + pos, literal.data(), literal.size()) &&
+						match_from<Parsed, I + 1>(input, pos + literal.size(), captures);
+				}
+				else if constexpr (segment.type == match_segment::kind::any)
+				{
+					return pos < input.size() && match_from<Parsed, I + 1>(input, pos + 1, captures);
+				}
+				else if constexpr (segment.type == match_segment::kind::set)
+				{
+					return pos < input.size() && segment.chars.contains(input[pos]) && match_from<Parsed, I + 1>(input, pos + 1, captures);
+				}
+				else
+				{
+					constexpr bool is_capture = segment.type == match_segment::kind::capture;
+					constexpr std::size_t min_length = is_capture ? 1 : 0;
+					std::size_t limit = input.size();
+					if constexpr (is_capture)
+					{
+						limit = std::min(limit, detail::find_char(input.data(), input.size(), '/', pos));
+					}
+
+					if constexpr (I + 1 == Parsed::count)
+					{
+						if (limit != input.size() || input.size() - pos < min_length)
+						{
+							return false;
+						}
+						captures[segment.slot] = input.substr(pos);
+						return true;
+					}
+					else if constexpr (Parsed::segments[I + 1].type == match_segment::kind::literal)
+					{
+						constexpr std::string_view next = Parsed::template literal<I + 1>;
+						for (std::size_t end = detail::find_chars(input.data(), input.size(), next.data(), next.size(), pos + min_length);
+							end != npos && end <= limit;
+							end = detail::find_chars(input.data(), input.size(), next.data(), next.size(), end + 1))
+						{
+							if (match_from<Parsed, I + 1>(input, end, captures))
+							{
+								captures[segment.slot] = input.substr(pos, end - pos);
+								return true;
+							}
+						}
+						return false;
+					}
+					else
+					{
+						for (std::size_t end = pos + min_length; end <= limit; ++end)
+						{
+							if (match_from<Parsed, I + 1>(input, end, captures))
+							{
+								captures[segment.slot] = input.substr(pos, end - pos);
+								return true;
+							}
+						}
+						return false;
+					}
+				}
 			}
 		}
-
-		std::array<char, BufferCapacity + 1> _data{}; ///< Internal fixed buffer (+1 for null terminator).
-		size_type _size{}; ///< Number of characters currently stored.
-	};
-
-	template<std::size_t N>
-	string_impl(const char(&)[N]) -> string_impl<N>;
-
-	// ======================================================================
-	//                           Operators
-	// ======================================================================
+	} // namespace detail
 
 	/**
-	 * @brief Concatenates two hybrid strings.
-	 *
-	 * @tparam B1 Capacity of the first string's compile-time buffer.
-	 * @tparam DynamicExpandCapacity1 Dynamic capacity of the first string.
-	 * @tparam B2 Capacity of the second string's compile-time buffer.
-	 * @tparam DynamicExpandCapacity2 Dynamic capacity of the second string.
-	 *
-	 * @return A new string_impl with combined compile-time and dynamic capacities.
+	 * @brief Outcome of hybstr::match: whether the input matched, and the captured views into it.
+	 * @tparam Pattern The pattern, a hybstr::string_impl instance.
 	 */
-	template<
-		std::size_t B1, std::size_t DynamicExpandCapacity1,
-		std::size_t B2, std::size_t DynamicExpandCapacity2
-	>
-	[[nodiscard]] constexpr auto operator+(
-		const string_impl<B1, DynamicExpandCapacity1>& s1,
-		const string_impl<B2, DynamicExpandCapacity2>& s2
-		) noexcept
+	template<auto Pattern>
+	class match_result
 	{
-		string_impl<
-			B1 + B2,
-			std::max(DynamicExpandCapacity1, DynamicExpandCapacity2)
-		> result{};
+		using parsed = detail::parsed_match<Pattern>;
+
+	public:
+		/// @brief Number of captures ('{...}' and '*', left to right).
+		static constexpr std::size_t capture_count = parsed::captures();
+
+		constexpr match_result() noexcept = default;
 
-		for (std::size_t i = 0; i < s1.size(); ++i)
+		[[nodiscard]] constexpr explicit operator bool() const noexcept
 		{
-			result._data[i] = s1._data[i];
+			return _matched;
 		}
-		for (std::size_t i = 0; i < s2.size(); ++i)
+		/** @return True if the whole input matched. */
+		[[nodiscard]] constexpr auto matched() const noexcept -> bool
 		{
-			result._data[s1.size() + i] = s2._data[i];
+			return _matched;
 		}
-
-		result._size = s1._size + s2._size;
-		result._data[result._size] = '\0';
-		return result;
-	}
-
-	/**
-	 * @brief Concatenates a hybrid string with a C-style string literal.
-	 */
-	template<
-		std::size_t BufferCapacity,
-		std::size_t DynamicExpandCapacity,
-		std::size_t N
-	>
-	[[nodiscard]] constexpr auto operator+(
-		const string_impl<BufferCapacity, DynamicExpandCapacity>& s,
-		const char(&str)[N]
-		) noexcept
-	{
-		string_impl<BufferCapacity + N, DynamicExpandCapacity> result{};
-
-		for (std::size_t i = 0; i < s.size(); ++i)
+		/** @return Capture @p i (empty if the input did not match). */
+		[[nodiscard]] constexpr auto operator[](std::size_t i) const noexcept -> std::string_view
 		{
-			result._data[i] = s._data[i];
+			return _captures[i];
 		}
-		for (std::size_t i = 0; i < N - 1; ++i)
+		/** @return The capture written as '{Name}' in the pattern. */
+		template<auto Name>
+		[[nodiscard]] constexpr auto get() const noexcept -> std::string_view
 		{
-			result._data[s.size() + i] = str[i];
+			constexpr std::size_t slot = parsed::slot_of(Name.view());
+			return _captures[slot];
+		}
+		/** @return All captures. */
+		[[nodiscard]] constexpr auto captures() const noexcept -> const std::array<std::string_view, capture_count>&
+		{
+			return _captures;
 		}
 
-		result._size = s.size() + N - 1;
-		result._data[result._size] = '\0';
-
-		return result;
-	}
-
+		std::array<std::string_view, capture_count> _captures{};
+		bool _matched = false;
+	};
 
 	/**
-	 * @brief Concatenates a C-style string literal with a hybrid string.
+	 * @brief Matches @p input against a pattern compiled at compile time. C++20 or above.
+	 *
+	 * @details
+	 * The whole input must match. Pattern syntax:
+	 * - '{name}' or '{}': captures one or more characters other than '/'.
+	 * - '*': captures any characters, possibly none.
+	 * - '?': any one character. '[abc]', '[a-z0-9]', '[^/]': one character of a set (or not in it).
+	 * - '\\' escapes the next character; everything else matches itself.
+	 *
+	 * The pattern is parsed once during compilation into a fixed sequence of literal compares, set
+	 * lookups and capture scans, so nothing is parsed or allocated at runtime. Captures take the shortest
+	 * run that lets the rest match. Captured views point into @p input.
+	 * @code
+	 * using namespace hybstr::literals;
+	 * constexpr auto m = hybstr::match<"GET /api/{id}/{field}"_hyb>("GET /api/42/name");
+	 * static_assert(m && m.get<"id"_hyb>() == "42" && m[1] == "name");
+	 * static_assert(hybstr::match<"*.tar.gz"_hyb>("logs.tar.gz")[0] == "logs");
+	 * static_assert(!hybstr::match<"v[0-9].[0-9]"_hyb>("v1.x"));
+	 * @endcode
+	 *
+	 * @tparam Pattern The pattern, a hybstr::string_impl instance.
 	 */
-	template<
-		std::size_t BufferCapacity,
-		std::size_t DynamicExpandCapacity,
-		std::size_t N
-	>
-	[[nodiscard]] constexpr auto operator+(
-		const char(&str)[N],
-		const string_impl<BufferCapacity, DynamicExpandCapacity>& s
-		) noexcept
+	template<auto Pattern>
+	[[nodiscard]] constexpr auto match(std::string_view input) noexcept -> match_result<Pattern>
 	{
-		string_impl<BufferCapacity + N, DynamicExpandCapacity> result{};
+		static_assert(is_string_impl_v<std::remove_cvref_t<decltype(Pattern)>>, "Expect a hybstr::string_impl pattern");
 
-		for (std::size_t i = 0; i < N - 1; ++i)
+		match_result<Pattern> result;
+		result._matched = detail::match_from<detail::parsed_match<Pattern>, 0>(input, 0, result._captures.data());
+		if (!result._matched)
 		{
-			result._data[i] = str[i];
+			result._captures = {};
 		}
-		for (std::size_t i = 0; i < s.size(); ++i)
-		{
-			result._data[N + i - 1] = s._data[i];
-		}
-
-		result._size = s.size() + N - 1;
-		result._data[result._size] = '\0';
-
 		return result;
 	}
-
-
-	/**
-	 * @brief Concatenates a hybrid string with a char.
-	 */
-	template<
-		std::size_t BufferCapacity,
-		std::size_t DynamicExpandCapacity
-	>
-	[[nodiscard]] constexpr auto operator+(
-		const string_impl<BufferCapacity, DynamicExpandCapacity>& s,
-		char c
-		) noexcept
+	/** @brief Matches the contents of @p input. The captures point into it. */
+	template<auto Pattern, std::size_t B, std::size_t D, typename P>
+	[[nodiscard]] constexpr auto match(const string_impl<B, D, P>& input) noexcept -> match_result<Pattern>
 	{
-		string_impl<BufferCapacity + 1, DynamicExpandCapacity> result{};
+		return match<Pattern>(input.view());
+	}
+#endif
 
-		for (std::size_t i = 0; i < s.size(); ++i)
-		{
-			result._data[i] = s._data[i];
-		}
-		result._size = s.size() + 1;
-		result._data[result._size - 1] = c;
-		result._data[result._size] = '\0';
+	// ======================================================================
+	//                           ASCII Transforms
+	// ======================================================================
 
-		return result;
+	/** @return @p sv without leading and trailing ASCII whitespace. */
+	[[nodiscard]] constexpr auto trim(std::string_view sv) noexcept -> std::string_view
+	{
+		return detail::trim_view<true, true>(sv);
+	}
+	/** @return @p sv without leading ASCII whitespace. */
+	[[nodiscard]] constexpr auto trim_left(std::string_view sv) noexcept -> std::string_view
+	{
+		return detail::trim_view<true, false>(sv);
+	}
+	/** @return @p sv without trailing ASCII whitespace. */
+	[[nodiscard]] constexpr auto trim_right(std::string_view sv) noexcept -> std::string_view
+	{
+		return detail::trim_view<false, true>(sv);
 	}
 
 	/**
-	 * @brief Concatenates a hybrid string with a char.
+	 * @brief Equality ignoring ASCII case, for hybrid strings, hashed strings and string views in any mix.
+	 * @code
+	 * static_assert(hybstr::iequals("Content-Type", hybstr::string("content-type")));
+	 * @endcode
 	 */
-	template<
-		std::size_t BufferCapacity,
-		std::size_t DynamicExpandCapacity
-	>
-	[[nodiscard]] constexpr auto operator+(
-		char c,
-		const string_impl<BufferCapacity, DynamicExpandCapacity>& s
-		) noexcept
+	template<typename T1, typename T2>
+	[[nodiscard]] constexpr auto iequals(const T1& lhs, const T2& rhs) noexcept -> bool
 	{
-		string_impl<BufferCapacity + 1, DynamicExpandCapacity> result{};
-
-		result._data[0] = c;
-		for (std::size_t i = 0; i < s.size(); ++i)
-		{
-			result._data[i + 1] = s._data[i];
-		}
-		result._size = s.size() + 1;
-		result._data[result._size] = '\0';
-
-		return result;
+		const std::string_view a = detail::as_view(lhs);
+		const std::string_view b = detail::as_view(rhs);
+		return a.size() == b.size() && detail::iequal_prefix(a.data(), b.data(), a.size()) == a.size();
 	}
-
 	/**
-	 * @brief Concatenates a hybrid string with a std::string_view.
+	 * @brief Three-way comparison ignoring ASCII case.
+	 * @return Negative, zero or positive, like std::string_view::compare.
 	 */
-	template<
-		std::size_t BufferCapacity,
-		std::size_t DynamicExpandCapacity
-	>
-	[[nodiscard]] constexpr auto operator+(
-		const string_impl<BufferCapacity, DynamicExpandCapacity>& s,
-		std::string_view sv
-		) noexcept
+	template<typename T1, typename T2>
+	[[nodiscard]] constexpr auto icompare(const T1& lhs, const T2& rhs) noexcept -> int
 	{
-		string_impl<BufferCapacity + DynamicExpandCapacity, DynamicExpandCapacity> result{};
+		const std::string_view a = detail::as_view(lhs);
+		const std::string_view b = detail::as_view(rhs);
+		return detail::icompare_chars(a.data(), a.size(), b.data(), b.size());
+	}
+
+	// ======================================================================
+	//                           UTF-8
+	// ======================================================================
 
-		for (std::size_t i = 0; i < s.size(); ++i)
+	namespace detail
+	{
+		/** @brief Number of set bits of @p x. */
+		constexpr auto popcount64(std::uint64_t x) noexcept -> unsigned
 		{
-			result._data[i] = s._data[i];
+			x = x - ((x >> 1) & 0x5555555555555555ull);
+			x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+			x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+			return static_cast<unsigned>((x * 0x0101010101010101ull) >> 56);
 		}
-		for (std::size_t i = 0; i < sv.size(); ++i)
+
+		/** @brief True for UTF-8 continuation bytes (10xxxxxx). */
+		constexpr auto is_utf8_continuation(char c) noexcept -> bool
 		{
-			result._data[s.size() + i] = sv[i];
+			return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
 		}
 
-		result._size = s.size() + sv.size();
-		result._data[result._size] = '\0';
+		/**
+		 * @brief Length of the well-formed UTF-8 sequence starting at @p p (at most @p n bytes), or 0 if it is not.
+		 *
+		 * @details
+		 * Follows Table 3-7 of the Unicode standard: overlong forms, surrogates (U+D800-U+DFFF) and
+		 * values above U+10FFFF are rejected by narrowing the range of the second byte.
+		 */
+		constexpr auto utf8_sequence_length(const char* p, std::size_t n) noexcept -> std::size_t
+		{
+			const auto lead = static_cast<unsigned char>(p[0]);
+			if (lead < 0x80)
+			{
+				return 1;
+			}
+
+			std::size_t length = 0;
+			unsigned char lo = 0x80;
+			unsigned char hi = 0xBF;
+			if (lead >= 0xC2 && lead <= 0xDF)
+			{
+				length = 2;
+			}
+			else if (lead >= 0xE0 && lead <= 0xEF)
+			{
+				length = 3;
+				lo = lead == 0xE0 ? 0xA0 : 0x80;
+				hi = lead == 0xED ? 0x9F : 0xBF;
+			}
+			else if (lead >= 0xF0 && lead <= 0xF4)
+			{
+				length = 4;
+				lo = lead == 0xF0 ? 0x90 : 0x80;
+				hi = lead == 0xF4 ? 0x8F : 0xBF;
+			}
+			else
+			{
+				return 0;
+			}
 
-		return result;
-	}
+			if (n < length)
+			{
+				return 0;
+			}
+			const auto second = static_cast<unsigned char>(p[1]);
+			if (second < lo || second > hi)
+			{
+				return 0;
+			}
+			for (std::size_t i = 2; i < length; ++i)
+			{
+				if (!is_utf8_continuation(p[i]))
+				{
+					return 0;
+				}
+			}
+			return length;
+		}
 
-	/**
-	 * @brief Concatenates a std::string_view with a hybrid string.
-	 */
-	template<
-		std::size_t BufferCapacity,
-		std::size_t DynamicExpandCapacity
-	>
-	[[nodiscard]] constexpr auto operator+(
-		std::string_view sv,
-		const string_impl<BufferCapacity, DynamicExpandCapacity>& s
-		) noexcept
-	{
-		return s + sv;
-	}
+		/** @brief Number of leading ASCII bytes of @p p, counted 16 (SSE2) or 8 at a time. Runtime only. */
+		inline auto ascii_prefix(const char* p, std::size_t n) noexcept -> std::size_t
+		{
+			std::size_t i = 0;
+#if HYBSTR_HAS_SSE2
+			for (; i + 16 <= n; i += 16)
+			{
+				const unsigned high = static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))));
+				if (high != 0)
+				{
+					return i + lowest_bit(high);
+				}
+			}
+#endif
+			for (; i + 8 <= n; i += 8)
+			{
+				std::uint64_t word;
+				std::memcpy(&word, p + i, 8);
+				if ((word & broadcast_byte(0x80)) != 0)
+				{
+					break;
+				}
+			}
+			while (i < n && static_cast<unsigned char>(p[i]) < 0x80)
+			{
+				++i;
+			}
+			return i;
+		}
 
+		/** @brief Runtime part of 'utf8_error': ASCII runs are skipped a block at a time. */
+		HYBSTR_NOINLINE inline auto utf8_error_runtime(const char* p, std::size_t n) noexcept -> std::size_t
+		{
+			std::size_t i = 0;
+			while (i < n)
+			{
+				i += ascii_prefix(p + i, n - i);
+				if (i == n)
+				{
+					break;
+				}
+				const std::size_t length = utf8_sequence_length(p + i, n - i);
+				if (length == 0)
+				{
+					return i;
+				}
+				i += length;
+			}
+			return npos;
+		}
 
-	// ======================================================================
-	//                           Comparisons
-	// =====================================================================
+		/** @brief Offset of the first byte of @p p that does not start a well-formed sequence, or npos. */
+		constexpr auto utf8_error(const char* p, std::size_t n) noexcept -> std::size_t
+		{
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				return utf8_error_runtime(p, n);
+			}
+			std::size_t i = 0;
+			while (i < n)
+			{
+				const std::size_t length = utf8_sequence_length(p + i, n - i);
+				if (length == 0)
+				{
+					return i;
+				}
+				i += length;
+			}
+			return npos;
+		}
 
-	/**
-	 * @brief Equality comparison for two hybrid strings.
-	 */
-	template<
-		std::size_t B1, std::size_t D1,
-		std::size_t B2, std::size_t D2
-	>
-	[[nodiscard]] constexpr bool operator==(
-		const string_impl<B1, D1>& s1,
-		const string_impl<B2, D2>& s2
-		) noexcept
-	{
-		if (s1._size != s2._size)
+		/** @brief Runtime part of 'utf8_lead_count'. */
+		HYBSTR_NOINLINE inline auto utf8_lead_count_runtime(const char* p, std::size_t n) noexcept -> std::size_t
+		{
+			std::size_t count = 0;
+			std::size_t i = 0;
+#if HYBSTR_HAS_SSE2
+			// Continuation bytes are the signed values below -64. Per-byte counters are summed
+			// with psadbw before they can overflow (255 blocks).
+			const __m128i limit = _mm_set1_epi8(-65);
+			__m128i total = _mm_setzero_si128();
+			while (i + 16 <= n)
+			{
+				__m128i lanes = _mm_setzero_si128();
+				for (std::size_t k = 0; k < 255 && i + 16 <= n; ++k, i += 16)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+					lanes = _mm_sub_epi8(lanes, _mm_cmpgt_epi8(block, limit));
+				}
+				total = _mm_add_epi64(total, _mm_sad_epu8(lanes, _mm_setzero_si128()));
+			}
+			alignas(16) std::uint64_t sums[2]{};
+			_mm_store_si128(reinterpret_cast<__m128i*>(sums), total);
+			count += static_cast<std::size_t>(sums[0] + sums[1]);
+#endif
+			for (; i + 8 <= n; i += 8)
+			{
+				std::uint64_t word = 0;
+				std::memcpy(&word, p + i, 8);
+				const std::uint64_t continuation = word & ~(word << 1) & broadcast_byte(0x80);
+				count += 8 - popcount64(continuation);
+			}
+			for (; i < n; ++i)
+			{
+				count += !is_utf8_continuation(p[i]);
+			}
+			return count;
+		}
+
+		/** @brief Number of bytes of @p p that are not continuation bytes. */
+		constexpr auto utf8_lead_count(const char* p, std::size_t n) noexcept -> std::size_t
 		{
-			return false;
+			if (!HYBSTR_IS_CONSTANT_EVALUATED)
+			{
+				return utf8_lead_count_runtime(p, n);
+			}
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				count += !is_utf8_continuation(p[i]);
+			}
+			return count;
 		}
 
-		for (std::size_t i = 0; i < s1._size; ++i)
+		/**
+		 * @brief Decodes the sequence at @p p into @p out.
+		 * @return Bytes consumed. An ill-formed sequence yields U+FFFD and consumes one byte.
+		 */
+		constexpr auto decode_utf8(const char* p, std::size_t n, char32_t& out) noexcept -> std::size_t
 		{
-			if (s1._data[i] != s2._data[i])
+			const std::size_t length = utf8_sequence_length(p, n);
+			const auto lead = static_cast<unsigned char>(p[0]);
+			switch (length)
+			{
+			case 1:
+				out = lead;
+				return 1;
+			case 2:
+				out = (char32_t{ lead } & 0x1F) << 6;
+				break;
+			case 3:
+				out = (char32_t{ lead } & 0x0F) << 12;
+				break;
+			case 4:
+				out = (char32_t{ lead } & 0x07) << 18;
+				break;
+			default:
+				out = U'\uFFFD';
+				return 1;
+			}
+			for (std::size_t i = 1; i < length; ++i)
 			{
-				return false;
+				out |= (char32_t{ static_cast<unsigned char>(p[i]) } & 0x3F) << (6 * (length - 1 - i));
 			}
+			return length;
 		}
-		return true;
-	}
-
+	} // namespace detail
 
 	/**
-	 * @brief Inequality comparison for two hybrid strings.
+	 * @brief True if @p s is well-formed UTF-8 (no overlong forms, surrogates or values above U+10FFFF).
+	 * Runs of ASCII are skipped 16 bytes at a time at runtime.
 	 */
-	template<
-		std::size_t B1, std::size_t D1,
-		std::size_t B2, std::size_t D2
-	>
-	[[nodiscard]] constexpr bool operator!=(
-		const string_impl<B1, D1>& s1,
-		const string_impl<B2, D2>& s2
-		) noexcept
+	template<typename T>
+	[[nodiscard]] constexpr auto is_valid_utf8(const T& s) noexcept -> bool
 	{
-		return !(s1 == s2);
+		const std::string_view sv = detail::as_view(s);
+		return detail::utf8_error(sv.data(), sv.size()) == detail::npos;
+	}
+	/** @return Offset of the first byte of @p s that does not start a well-formed sequence, or std::string_view::npos if valid. */
+	template<typename T>
+	[[nodiscard]] constexpr auto utf8_error_offset(const T& s) noexcept -> std::size_t
+	{
+		const std::string_view sv = detail::as_view(s);
+		return detail::utf8_error(sv.data(), sv.size());
 	}
-
-#if HYBSTR_CPP_20_OR_ABOVE
 	/**
-	 * @brief Lexicographical three-way comparison for hybrid strings. C++20 or above.
+	 * @brief Number of codepoints in @p s, i.e. of bytes that are not continuation bytes.
+	 * Exact for valid UTF-8; validate first if the input is untrusted.
 	 */
-	template<
-		std::size_t B1, std::size_t D1,
-		std::size_t B2, std::size_t D2
-	>
-	[[nodiscard]] constexpr auto operator<=>(
-		const string_impl<B1, D1>& s1,
-		const string_impl<B2, D2>& s2
-		) noexcept
+	template<typename T>
+	[[nodiscard]] constexpr auto codepoint_count(const T& s) noexcept -> std::size_t
 	{
-		const std::size_t min_size = std::min(s1._size, s2._size);
-
-		for (std::size_t i = 0; i < min_size; ++i)
-		{
-			if (auto cmp = s1._data[i] <=> s2._data[i]; cmp != 0)
-			{
-				return cmp;
-			}
-		}
-		return s1._size <=> s2._size;
+		const std::string_view sv = detail::as_view(s);
+		return detail::utf8_lead_count(sv.data(), sv.size());
 	}
-
-#else
 	/**
-	 * @brief Less than comparison for two hybrid strings. C++17.
+	 * @return Longest prefix length of @p sv that is at most @p n bytes and does not end inside a sequence.
 	 */
-	template<
-		std::size_t B1, std::size_t D1,
-		std::size_t B2, std::size_t D2
-	>
-	[[nodiscard]] constexpr bool operator<(
-		const string_impl<B1, D1>& s1,
-		const string_impl<B2, D2>& s2
-		) noexcept
+	[[nodiscard]] constexpr auto utf8_prefix_size(std::string_view sv, std::size_t n) noexcept -> std::size_t
 	{
-		const std::size_t min_size = std::min(s1._size, s2._size);
-
-		for (std::size_t i = 0; i < min_size; ++i)
+		if (n >= sv.size())
+		{
+			return sv.size();
+		}
+		std::size_t cut = n;
+		while (cut > 0 && n - cut < 3 && detail::is_utf8_continuation(sv[cut]))
 		{
-			if (s1._data[i] < s2._data[i]) return true;
-			else return false;
+			--cut;
 		}
-		return s1._size < s2._size;
+		return detail::is_utf8_continuation(sv[cut]) ? n : cut;
 	}
-
 	/**
-	 * @brief Less than or equal to comparison for two hybrid strings.
+	 * @brief Copies @p sv into a string_impl of capacity N, cutting on a codepoint boundary.
+	 *
+	 * @details
+	 * The string_view constructor keeps the first BufferCapacity bytes and may split a multi-byte
+	 * sequence. This keeps at most N bytes and drops a trailing partial sequence instead.
+	 * @code
+	 * auto name = hybstr::truncate_utf8<4>("h\xC3\xA9h\xC3\xA9");   // "h\xC3\xA9h", 4 bytes
+	 * @endcode
 	 */
-	template<
-		std::size_t B1, std::size_t D1,
-		std::size_t B2, std::size_t D2
-	>
-	[[nodiscard]] constexpr bool operator<=(
-		const string_impl<B1, D1>& s1,
-		const string_impl<B2, D2>& s2
-		) noexcept
+	template<std::size_t N, std::size_t DynamicExpandCapacity = HYBSTR_DYNAMIC_EXPAND_CAPACITY, typename Policy = default_policy>
+	[[nodiscard]] constexpr auto truncate_utf8(std::string_view sv) noexcept
 	{
-		return !(s2 < s1);
+		return string_impl<detail::policy_capacity_v<Policy, N>, DynamicExpandCapacity, Policy>{ sv.substr(0, utf8_prefix_size(sv, N)) };
 	}
 
 	/**
-	 * @brief Greater than comparison for two hybrid strings.
+	 * @brief Forward range of the codepoints (char32_t) of a UTF-8 string. Does not own the characters.
+	 * Ill-formed bytes decode to U+FFFD, one per byte.
+	 * @code
+	 * for (char32_t cp : hybstr::codepoints(field)) { ... }
+	 * @endcode
 	 */
-	template<
-		std::size_t B1, std::size_t D1,
-		std::size_t B2, std::size_t D2
-	>
-	[[nodiscard]] constexpr bool operator>(
-		const string_impl<B1, D1>& s1,
-		const string_impl<B2, D2>& s2
-		) noexcept
+	class utf8_view
 	{
-		return s2 < s1;
-	}
+	public:
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = char32_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const char32_t*;
+			using reference = char32_t;
 
-	/**
-	 * @brief Greater than or equal to comparison for two hybrid strings.
-	 */
-	template<
-		std::size_t B1, std::size_t D1,
-		std::size_t B2, std::size_t D2
-	>
-	[[nodiscard]] constexpr bool operator>=(
-		const string_impl<B1, D1>& s1,
-		const string_impl<B2, D2>& s2
-	) noexcept
-	{
-		return !(s1 < s2);
-	}
-#endif
+			constexpr iterator() noexcept = default;
 
-	// ======================================================================
-	//                           Traits and Utilities
-	// ======================================================================
+			[[nodiscard]] constexpr auto operator*() const noexcept -> char32_t
+			{
+				return _value;
+			}
+			constexpr auto operator++() noexcept -> iterator&
+			{
+				_pos += _length;
+				_decode();
+				return *this;
+			}
+			constexpr auto operator++(int) noexcept -> iterator
+			{
+				iterator copy = *this;
+				++*this;
+				return copy;
+			}
+			/** @return Byte offset of the current codepoint. */
+			[[nodiscard]] constexpr auto offset() const noexcept -> std::size_t
+			{
+				return _pos;
+			}
 
-	/**
-	 * @brief Type trait for detecting hybstr::string_impl.
-	 */
-	template<typename T>
-	struct is_string_impl : std::false_type {};
-	template <std::size_t BufferCapacity, std::size_t DynamicExpandCapacity>
-	struct is_string_impl<string_impl<BufferCapacity, DynamicExpandCapacity>> : std::true_type {};
+			[[nodiscard]] friend constexpr bool operator==(const iterator& a, const iterator& b) noexcept
+			{
+				return a._pos == b._pos;
+			}
+			[[nodiscard]] friend constexpr bool operator!=(const iterator& a, const iterator& b) noexcept
+			{
+				return a._pos != b._pos;
+			}
 
-	/// @brief Shorthand boolean variable for is_string_impl.
-	template <typename T>
-	inline constexpr bool is_string_impl_v = is_string_impl<T>::value;
+		private:
+			friend class utf8_view;
 
-#if HYBSTR_CPP_20_OR_ABOVE
-	/**
-	 * @brief Adjusts the compile-time buffer size to exactly fit the string content. C++20 or above.
-	 *
-	 * @tparam str A hybstr::string_impl instance (must be known at compile time).
-	 * @return A new string_impl whose BufferCapacity equals its current size.
-	 */
-	template <auto str>
-	[[nodiscard]] consteval auto fit_string() noexcept
+			constexpr iterator(std::string_view sv, std::size_t pos) noexcept
+				: _sv(sv), _pos(pos)
+			{
+				_decode();
+			}
+			constexpr void _decode() noexcept
+			{
+				_length = _pos < _sv.size() ? detail::decode_utf8(_sv.data() + _pos, _sv.size() - _pos, _value) : 0;
+			}
+
+			std::string_view _sv;
+			std::size_t _pos = 0;
+			std::size_t _length = 0;
+			char32_t _value = 0;
+		};
+
+		constexpr explicit utf8_view(std::string_view sv) noexcept
+			: _sv(sv)
+		{
+		}
+
+		[[nodiscard]] constexpr auto begin() const noexcept -> iterator
+		{
+			return iterator(_sv, 0);
+		}
+		[[nodiscard]] constexpr auto end() const noexcept -> iterator
+		{
+			return iterator(_sv, _sv.size());
+		}
+		/** @return The underlying bytes. */
+		[[nodiscard]] constexpr auto bytes() const noexcept -> std::string_view
+		{
+			return _sv;
+		}
+
+	private:
+		std::string_view _sv;
+	};
+
+	/** @return The codepoints of @p sv. */
+	[[nodiscard]] constexpr auto codepoints(std::string_view sv) noexcept -> utf8_view
 	{
-		static_assert(is_string_impl_v<std::remove_cvref_t<decltype(str)>>, "Expect a vre::string as input");
-		return str.template resize<str.size()>();
+		return utf8_view(sv);
 	}
-#endif
-
-#if HYBSTR_CPP_20_OR_ABOVE
-	/**
-	 * @brief Adjusts the compile-time buffer size to exactly fit the string content. C++20 or above.
-	 *
-	 * @details
-	 * Returns a resized copy of @p str whose buffer capacity equals its current size.
-	 * The expression is 'constexpr' if @p str supports compile-time evaluation.
-	 *
-	 * @param str A 'hybstr::string_impl' instance.
-	 * @return A new 'string_impl' whose buffer capacity matches its current size.
-	 */
-	#define HYBSTR_FIT_STRING(str)\
-		hybstr::fit_string<(str)>()
-#else
-	/**
-	 * @brief Adjusts the compile-time buffer size to exactly fit the string content. C++17.
-	 *
-	 * @details
-	 * C++17 fallback macro version of 'hybstr::fit_string'.
-	 * Returns a resized copy of @p str whose buffer capacity equals its current size.
-	 * The expression is 'constexpr' if @p str supports compile-time evaluation.
-	 *
-	 * @param str A 'hybstr::string_impl' instance.
-	 * @return A new 'string_impl' whose buffer capacity matches its current size.
-	 */
-	#define HYBSTR_FIT_STRING(str) \
-		([&]() constexpr noexcept { return (str).template resize<(str).size()>(); })()
-#endif
+	/** @return The codepoints of @p s. */
+	template<std::size_t B, std::size_t D, typename P>
+	[[nodiscard]] constexpr auto codepoints(const string_impl<B, D, P>& s) noexcept -> utf8_view
+	{
+		return utf8_view(s.view());
+	}
+	template<std::size_t B, std::size_t D, typename P>
+	auto codepoints(const string_impl<B, D, P>&&) = delete;
 
 	// ======================================================================
-	//                           Factory Functions
+	//                           Number Conversions
 	// ======================================================================
 
-	/**
-	 * @brief Creates an empty hybrid string.
-	 */
-	template<std::size_t DynamicExpandCapacity>
-	[[nodiscard]] constexpr auto string()
+	namespace detail
 	{
-		return string_impl<0, DynamicExpandCapacity>{};
-	}
+		/// @brief True for the types handled by to_string and parse.
+		template<typename T>
+		inline constexpr bool is_number_v = is_format_integer_v<T> || std::is_floating_point_v<T>;
 
-	/**
-	 * @brief Creates a hybrid string from a string literal.
-	 */
-	template<std::size_t DynamicExpandCapacity, std::size_t N>
-	[[nodiscard]] constexpr auto string(const char(&str)[N])
-	{
-		return string_impl<N, DynamicExpandCapacity>{str};
-	}
+		/** @brief Parses the whole of @p sv as a decimal integer, with an optional '-' for signed types. */
+		template<typename T>
+		constexpr auto parse_integer(std::string_view sv) noexcept -> std::optional<T>
+		{
+			using U = std::make_unsigned_t<T>;
+			std::size_t i = 0;
+			bool negative = false;
+			if constexpr (std::is_signed_v<T>)
+			{
+				negative = !sv.empty() && sv[0] == '-';
+				i = negative;
+			}
+			if (i == sv.size())
+			{
+				return std::nullopt;
+			}
+
+			const U limit = negative
+				? static_cast<U>(static_cast<U>(std::numeric_limits<T>::max()) + 1u)
+				: static_cast<U>(std::numeric_limits<T>::max());
+			U value = 0;
+			for (; i < sv.size(); ++i)
+			{
+				const auto digit = static_cast<unsigned char>(sv[i] - '0');
+				if (digit > 9 || value > static_cast<U>((limit - digit) / 10u))
+				{
+					return std::nullopt;
+				}
+				value = static_cast<U>(value * 10u + digit);
+			}
+			if (negative)
+			{
+				// Two's complement wrap, well defined on unsigned U.
+				return static_cast<T>(static_cast<U>(U{ 0 } - value));
+			}
+			return static_cast<T>(value);
+		}
+	} // namespace detail
 
 	/**
-	 * @brief Creates a hybrid string from a std::string_view.
+	 * @brief Converts a number to a hybrid string whose capacity is the worst case for @p T.
 	 *
-	 * @tparam ViewSize The known or estimated size of the string view.
-	 * @tparam DynamicExpandCapacity Dynamic buffer size for runtime usage.
+	 * @details
+	 * Integers are written two digits at a time and are usable in constant expressions.
+	 * Floating-point values use the shortest round-trip representation ('std::to_chars') and are runtime only.
+	 * @code
+	 * constexpr auto id = hybstr::to_string(-42);
+	 * static_assert(id.view() == "-42" && id.capacity() == 11);
+	 * @endcode
 	 */
-	template<std::size_t ViewSize, std::size_t DynamicExpandCapacity>
-	[[nodiscard]] constexpr auto string(std::string_view sv) noexcept
+	template<typename T, std::enable_if_t<detail::is_number_v<T>, int> = 0>
+	[[nodiscard]] constexpr auto to_string(T value) noexcept
 	{
-		return string_impl<ViewSize, DynamicExpandCapacity>{sv};
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			std::array<char, detail::floating_capacity_v<T>> buffer{};
+			const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+			return string_impl<detail::floating_capacity_v<T>>(std::string_view(buffer.data(), static_cast<std::size_t>(result.ptr - buffer.data())));
+		}
+		else
+		{
+			std::array<char, detail::integer_capacity_v<T>> buffer{};
+			return string_impl<detail::integer_capacity_v<T>>(std::string_view(buffer.data(), detail::write_integer(buffer.data(), value)));
+		}
 	}
 
 	/**
-	 * @brief Creates a hybrid string from an iterator range.
+	 * @brief Parses the whole of @p sv as a number of type @p T.
 	 *
-	 * @tparam RangeSize The known or estimated number of elements in the range.
-	 * @tparam DynamicExpandCapacity Dynamic buffer size for runtime usage.
-	 * @tparam _Iter Iterator type.
+	 * @details
+	 * Follows 'std::from_chars': no leading whitespace or '+', and '-' only for signed and floating-point types.
+	 * Integers are usable in constant expressions; floating-point values are parsed at runtime only.
+	 * @return The value, or std::nullopt if @p sv is not entirely a valid number or is out of range.
 	 */
-	template<std::size_t RangeSize, std::size_t DynamicExpandCapacity, typename _Iter>
-	[[nodiscard]] constexpr auto string(_Iter start, _Iter end) noexcept
+	template<typename T, std::enable_if_t<detail::is_number_v<T>, int> = 0>
+	[[nodiscard]] constexpr auto parse(std::string_view sv) noexcept -> std::optional<T>
+	{
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			T value{};
+			const char* last = sv.data() + sv.size();
+			const auto result = std::from_chars(sv.data(), last, value);
+			if (result.ec != std::errc() || result.ptr != last)
+			{
+				return std::nullopt;
+			}
+			return value;
+		}
+		else
+		{
+			return detail::parse_integer<T>(sv);
+		}
+	}
+	/** @brief Same as parse(std::string_view) for a hybrid string. */
+	template<typename T, std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy, std::enable_if_t<detail::is_number_v<T>, int> = 0>
+	[[nodiscard]] constexpr auto parse(const string_impl<BufferCapacity, DynamicExpandCapacity, Policy>& str) noexcept -> std::optional<T>
 	{
-		return string_impl<RangeSize, DynamicExpandCapacity>{start, end};
+		return parse<T>(str.view());
 	}
 } // namespace hybstr
 
@@ -1011,9 +8224,139 @@ namespace hybstr::literals
 	 * static_assert(s == hybstr::string("Hello"));
 	 * @endcode
 	 */
+#if defined(__GNUC__)
+	/*
+	 * GCC and Clang accept string literal operator templates as an extension, which gives
+	 * the literal length at compile time and so an exactly sized result.
+	 */
+	#pragma GCC diagnostic push
+	#if defined(__clang__)
+		#pragma GCC diagnostic ignored "-Wgnu-string-literal-operator-template"
+	#else
+		#pragma GCC diagnostic ignored "-Wpedantic"
+	#endif
+	template<typename CharT, CharT... Chars>
+	[[nodiscard]] consteval auto operator""_hyb() noexcept
+	{
+		static_assert(std::is_same_v<CharT, char>, "Expect a narrow string literal");
+		constexpr char str[] = { Chars..., '\0' };
+		return hybstr::string(str);
+	}
+	#pragma GCC diagnostic pop
+#else
+	/* Without the literal length at compile time the capacity falls back to HYBSTR_DYNAMIC_EXPAND_CAPACITY. */
 	[[nodiscard]] consteval auto operator""_hyb(const char* str, std::size_t len) noexcept
 	{
 		return hybstr::string(str, str + len);
 	}
+#endif
 	#endif
-}
\ No newline at end of file
+}
+
+/**
+ * @brief std::hash support, so string_impl can be used directly as an unordered container key.
+ */
+template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy>
+struct std::hash<hybstr::string_impl<BufferCapacity, DynamicExpandCapacity, Policy>>
+{
+	[[nodiscard]] auto operator()(const hybstr::string_impl<BufferCapacity, DynamicExpandCapacity, Policy>& s) const noexcept -> std::size_t
+	{
+		return hybstr::hash{}(s);
+	}
+};
+
+/**
+ * @brief std::hash support for hybstr::hashed_string, returning the cached hash.
+ */
+template<typename String>
+struct std::hash<hybstr::hashed_string<String>>
+{
+	[[nodiscard]] auto operator()(const hybstr::hashed_string<String>& s) const noexcept -> std::size_t
+	{
+		return s.hash();
+	}
+};
+
+#if HYBSTR_CPP_20_OR_ABOVE
+/**
+ * @brief std::hash support for hybstr::interned_ref, hashing the handle identity.
+ */
+template<>
+struct std::hash<hybstr::interned_ref>
+{
+	[[nodiscard]] auto operator()(const hybstr::interned_ref& ref) const noexcept -> std::size_t
+	{
+		return std::hash<const void*>{}(ref._entry);
+	}
+};
+#endif
+
+/**
+ * @brief std::hash support for hybstr::arena_string, matching hybstr::hash of the same contents.
+ */
+template<>
+struct std::hash<hybstr::arena_string>
+{
+	[[nodiscard]] auto operator()(const hybstr::arena_string& s) const noexcept -> std::size_t
+	{
+		return hybstr::hash{}(s.view());
+	}
+};
+
+#if HYBSTR_HAS_STD_FORMAT
+/**
+ * @brief std::format support. Accepts the 'std::string_view' format specs (width, fill, alignment, precision).
+ */
+template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy>
+struct std::formatter<hybstr::string_impl<BufferCapacity, DynamicExpandCapacity, Policy>, char> : std::formatter<std::string_view, char>
+{
+	template<typename FormatContext>
+	auto format(const hybstr::string_impl<BufferCapacity, DynamicExpandCapacity, Policy>& s, FormatContext& ctx) const
+	{
+		return std::formatter<std::string_view, char>::format(s.view(), ctx);
+	}
+};
+
+/**
+ * @brief std::format support for concatenation expressions, materialized in a fixed buffer first.
+ */
+template<typename L, typename R>
+struct std::formatter<hybstr::concat_expr<L, R>, char> : std::formatter<std::string_view, char>
+{
+	template<typename FormatContext>
+	auto format(const hybstr::concat_expr<L, R>& expr, FormatContext& ctx) const
+	{
+		const auto s = expr.materialize();
+		return std::formatter<std::string_view, char>::format(s.view(), ctx);
+	}
+};
+#endif
+
+#if defined(FMT_VERSION) && FMT_VERSION >= 80000
+/**
+ * @brief {fmt} support, enabled when fmt is included before hybstr.hpp. Accepts the string format specs.
+ */
+template<std::size_t BufferCapacity, std::size_t DynamicExpandCapacity, typename Policy>
+struct fmt::formatter<hybstr::string_impl<BufferCapacity, DynamicExpandCapacity, Policy>, char> : fmt::formatter<fmt::string_view, char>
+{
+	template<typename FormatContext>
+	auto format(const hybstr::string_impl<BufferCapacity, DynamicExpandCapacity, Policy>& s, FormatContext& ctx) const -> decltype(ctx.out())
+	{
+		return fmt::formatter<fmt::string_view, char>::format(fmt::string_view(s.data(), s.size()), ctx);
+	}
+};
+
+/**
+ * @brief {fmt} support for concatenation expressions, materialized in a fixed buffer first.
+ */
+template<typename L, typename R>
+struct fmt::formatter<hybstr::concat_expr<L, R>, char> : fmt::formatter<fmt::string_view, char>
+{
+	template<typename FormatContext>
+	auto format(const hybstr::concat_expr<L, R>& expr, FormatContext& ctx) const -> decltype(ctx.out())
+	{
+		const auto s = expr.materialize();
+		return fmt::formatter<fmt::string_view, char>::format(fmt::string_view(s.data(), s.size()), ctx);
+	}
+};
+#endif